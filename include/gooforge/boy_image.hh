@@ -20,21 +20,46 @@
 #ifndef GOOFORGE_BOY_IMAGE_HH
 #define GOOFORGE_BOY_IMAGE_HH
 
+#include <cstdint>
 #include <expected>
+#include <memory>
 #include <string_view>
 
-#include "SFML/Graphics.hpp"
-
 #include "error.hh"
+#include "mapped_file.hh"
 
 namespace gooforge {
 
+// size of the header at the start of the compressed file, before the zstd data
+#define GOOFORGE_BOY_IMAGE_FILE_HEADER_SIZE 36
+// size of the header at the start of the decompressed data, before the pixels
+#define GOOFORGE_BOY_IMAGE_DATA_HEADER_SIZE 68
+// images wider or taller than this are rejected as corrupt, no texture that
+// big could be made from them anyway
+#define GOOFORGE_BOY_IMAGE_MAX_SIZE 16384
+
+// decoded RGBA pixels of a .image file, ready to be uploaded to a texture
 class BoyImage {
     public:
-        static std::expected<sf::Image, Error> loadFromFile(
+        static std::expected<BoyImage, Error> loadFromFile(
             std::string_view path);
+        // wraps pixels that live inside a mapped file, such as a cache entry
+        static BoyImage fromMappedFile(MappedFile file, size_t pixels_offset,
+                                       uint32_t width, uint32_t height);
+        uint32_t getWidth() const;
+        uint32_t getHeight() const;
+        const uint8_t* getPixels() const;
+        size_t getPixelsSize() const;
+
+    private:
+        uint32_t width = 0;
+        uint32_t height = 0;
+        const uint8_t* pixels = nullptr;
+        // exactly one of these backs pixels
+        std::unique_ptr<uint8_t[]> owned_pixels;
+        MappedFile mapped_file;
 };
 
 } // namespace gooforge
 
-#endif // GOOFORGE_BOY_IMAGE_HH
\ No newline at end of file
+#endif // GOOFORGE_BOY_IMAGE_HH
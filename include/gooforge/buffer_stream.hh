@@ -21,38 +21,117 @@
 #define GOOFORGE_BUFFER_STREAM_HH
 
 #include <cstring>
+#include <expected>
+#include <span>
 #include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#include "error.hh"
 
 namespace gooforge {
 
 class BufferStream {
     public:
-        BufferStream(char* buffer, size_t buffer_size)
+        BufferStream(const char* buffer, size_t buffer_size)
             : buffer(buffer), buffer_size(buffer_size), index(0) {}
         template <typename T>
         T read();
+        template <typename T>
+        std::expected<T, Error> tryRead();
+        template <typename T>
+        T peek() const;
+        // views into the buffer itself, so T must be suitably aligned there
+        template <typename T>
+        std::span<const T> readSpan(size_t count);
+        template <typename T>
+        std::expected<std::span<const T>, Error> tryReadSpan(size_t count);
+        // fixed size field holding a string that is cut off at the first NUL
+        template <size_t N>
+        std::string_view readFixedString();
+        // seeking to the end is allowed, there's just nothing left to read
         void seek(size_t seek_index, bool absolute = false);
-        char* remainder();
+        std::expected<void, Error> trySkip(size_t size);
+        const char* remainder();
+        size_t remaining() const;
 
     private:
-        char* buffer;
+        const char* buffer;
         size_t buffer_size;
         size_t index;
+        bool fits(size_t size) const;
 };
 
 template <typename T>
 T BufferStream::read() {
-    if (this->index + sizeof(T) > buffer_size) {
-        throw std::out_of_range("BufferStream::read out of range");
+    T value = this->peek<T>();
+    this->index += sizeof(T);
+
+    return value;
+}
+
+template <typename T>
+std::expected<T, Error> BufferStream::tryRead() {
+    if (!this->fits(sizeof(T))) {
+        return std::unexpected(
+            BufferReadError(this->index, sizeof(T), this->buffer_size));
+    }
+
+    return this->read<T>();
+}
+
+template <typename T>
+T BufferStream::peek() const {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    if (!this->fits(sizeof(T))) {
+        throw std::out_of_range("BufferStream::peek out of range");
     }
 
     T value;
     std::memcpy(&value, this->buffer + this->index, sizeof(T));
-    this->index += sizeof(T);
 
     return value;
 }
 
+template <typename T>
+std::span<const T> BufferStream::readSpan(size_t count) {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    if (count > this->remaining() / sizeof(T)) {
+        throw std::out_of_range("BufferStream::readSpan out of range");
+    }
+
+    std::span<const T> span(
+        reinterpret_cast<const T*>(this->buffer + this->index), count);
+    this->index += count * sizeof(T);
+
+    return span;
+}
+
+template <typename T>
+std::expected<std::span<const T>, Error> BufferStream::tryReadSpan(
+    size_t count) {
+    if (count > this->remaining() / sizeof(T)) {
+        return std::unexpected(BufferReadError(this->index, count * sizeof(T),
+                                               this->buffer_size));
+    }
+
+    return this->readSpan<T>(count);
+}
+
+template <size_t N>
+std::string_view BufferStream::readFixedString() {
+    if (!this->fits(N)) {
+        throw std::out_of_range("BufferStream::readFixedString out of range");
+    }
+
+    const char* string = this->buffer + this->index;
+    this->index += N;
+
+    return std::string_view(string, strnlen(string, N));
+}
+
 } // namespace gooforge
 
 #endif // GOOFORGE_BUFFER_STREAM_HH
\ No newline at end of file
@@ -27,6 +27,15 @@ namespace gooforge {
 // numbers declared in this file, for now it's fine
 #define GOOFORGE_PIXELS_PER_UNIT 100 // roughly 2160/19.05, calculated manually
 #define GOOFORGE_FRAMERATE_LIMIT 144
+#define GOOFORGE_MAX_TEXTURE_UPLOADS_PER_FRAME 4
+#define GOOFORGE_TEXTURE_CACHE_DEFAULT_SIZE_MB 2048
+#define GOOFORGE_TEXTURE_BUDGET_DEFAULT_MB 1024
+#define GOOFORGE_TEXTURE_EVICTION_IDLE_FRAMES 300 // a couple seconds
+#define GOOFORGE_LEVEL_LOAD_CHUNK_SIZE 256 // entities added per frame
+#define GOOFORGE_ITEM_CATALOG_INDEX_CHUNK_SIZE 16 // item files per pool task
+#define GOOFORGE_LEVEL_JOURNAL_FLUSH_INTERVAL_MS 500
+#define GOOFORGE_LEVEL_JOURNAL_COMPACT_SIZE_MB 4
+#define GOOFORGE_LEVEL_JOURNAL_RETRY_INTERVAL_MS 5000 // after a failed save
 
 } // namespace gooforge
 
@@ -20,15 +20,19 @@
 #ifndef GOOFORGE_EDITOR_HH
 #define GOOFORGE_EDITOR_HH
 
+#include <atomic>
 #include <deque>
 #include <filesystem>
 #include <functional>
+#include <future>
 #include <variant>
 
 #include "SFML/Graphics.hpp"
 
+#include "constants.hh"
 #include "error.hh"
 #include "level.hh"
+#include "level_journal.hh"
 
 namespace gooforge {
 
@@ -53,6 +57,9 @@ struct EditorAction {
 
 enum class EditorToolType { MOVE = 0, STRAND };
 
+// autosaves are only read back to replay the journal on top of
+enum class EditorSaveType { SAVE = 0, EXPORT, AUTOSAVE };
+
 struct SwitchToolEditorAction : public EditorAction {
     SwitchToolEditorAction(EditorToolType tool,
                        std::vector<EditorAction*> implicit_actions = {})
@@ -147,9 +154,32 @@ class Editor {
         bool panning = false;
         sf::Vector2f pan_start_position;
         std::filesystem::path wog2_path;
+        std::filesystem::path cache_path;
+        bool texture_cache_enabled = false;
+        int texture_cache_size_mb = GOOFORGE_TEXTURE_CACHE_DEFAULT_SIZE_MB;
+        int texture_budget_mb = GOOFORGE_TEXTURE_BUDGET_DEFAULT_MB;
         std::vector<Error> errors;
         Level* level = nullptr;
         std::string level_file_path;
+        // the save running in the background, if there is one
+        std::future<std::expected<void, Error>> save_result;
+        EditorSaveType save_type = EditorSaveType::SAVE;
+        std::atomic<float> save_progress = 0.0f;
+        // shown in the menu bar until the next save, failing to save
+        // shouldn't close the level like other errors do
+        std::string save_error;
+        // saving only writes the binary copy, until the level is exported the
+        // .wog2 the game reads doesn't have what was saved
+        bool level_exported = true;
+        // edits since the last save or autosave, for crash recovery. it's
+        // started once the level has been autosaved after opening
+        LevelJournal journal;
+        sf::Clock journal_clock;
+        bool journal_rebase_needed = false;
+        // a failed save doesn't leave anything for the journal to be written
+        // on top of, the autosave is retried every so often until one works
+        sf::Clock journal_retry_clock;
+        bool journal_retry_pending = false;
         std::vector<Entity*> selected_entities;
         std::deque<EditorAction*> undo_stack;
         sf::Clock undo_clock;
@@ -171,7 +201,19 @@ class Editor {
         void doEntitySelection(Entity* entity);
         void doEntitiesDeletion(std::vector<Entity*> entities);
         void doOpenFile();
-        void doCloseFile();
+        // the journal is kept for the next open to recover from when the
+        // level is being closed because something went wrong
+        void doCloseFile(bool keep_journal = false);
+        void doSave(EditorSaveType type);
+        bool isSaving() const;
+        // the pool is still parsing the level's resources, so nothing that
+        // could load one on the main thread may run
+        bool isLevelLoading() const;
+        void updateSave();
+        void updateJournal();
+        void flushJournal();
+        void retryJournal();
+        void closeJournal(bool keep_journal);
         void registerMainMenuBar();
         void registerErrorDialog();
         void showErrorDialog();
@@ -20,7 +20,9 @@
 #ifndef GOOFORGE_ENTITY_HH
 #define GOOFORGE_ENTITY_HH
 
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "SFML/Graphics.hpp"
 
@@ -29,7 +31,13 @@
 namespace gooforge {
 
 class GooBall;
+class BaseResource;
+class Level;
 class GooStrand;
+class SpriteResource;
+class ItemResource;
+class BallTemplateResource;
+class TerrainTemplatesResource;
 
 enum class Layer {
     BACKGROUND = 0,
@@ -74,7 +82,7 @@ enum class EntityType {
 class Entity {
     public:
         Entity(EntityType type) : type(type) {}
-        virtual ~Entity() {}
+        virtual ~Entity();
         virtual std::expected<void, Error> refresh() {
             return std::expected<void, Error>{};
         }
@@ -86,6 +94,8 @@ class Entity {
         bool getSelected();
         void setSelected(bool selected);
         void drawSelection(sf::RenderWindow* window);
+        void updatePendingSprite();
+        void touchSprite();
         virtual EntityType getType() const;
         virtual Vector2f getPosition() { return Vector2f(0.0f, 0.0f); }
         virtual float getRotation() { return 0.0f; }
@@ -99,12 +109,32 @@ class Entity {
         virtual void notifyRemoveStrand(GooStrand* strand) {}
         virtual void notifyUpdateBall(GooBall* ball) {}
         virtual void notifyUpdateStrand(GooStrand* strand) {}
+        void notifySpriteEvicted();
 
     protected:
+        void setSpriteResource(SpriteResource* sprite_resource);
+        // records the resources the entity was built from in the resource
+        // manager's dependency index, replacing the ones recorded before
+        void useResources(std::vector<BaseResource*> resources);
+        // every setter that changes what gets saved calls this, so the level
+        // only has to copy the entities that changed into its info
+        void markInfoDirty();
         EntityType type;
         EntityClickBoundShape* click_bounds = nullptr;
         bool selected = false;
         float rotation;
+        SpriteResource* sprite_resource = nullptr;
+        // sprite that was still loading at the last refresh
+        SpriteResource* pending_sprite = nullptr;
+        // the sprite's texture was evicted and has to be loaded back before
+        // it can be drawn
+        bool sprite_evicted = false;
+        // the level the entity is in, set and cleared by the level
+        Level* info_level = nullptr;
+        // where the entity is in the file the level's journal is written on
+        // top of, only meaningful while journal_generation matches the level's
+        size_t journal_index = 0;
+        uint64_t journal_generation = 0;
 
         friend class Level;
         friend struct EntityDepthComparator;
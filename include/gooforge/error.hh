@@ -36,6 +36,13 @@ struct JSONDeserializeError : BaseError {
         std::string glaze_message;
 };
 
+struct BEVEDeserializeError : BaseError {
+        BEVEDeserializeError(std::string file_path, std::string glaze_message);
+        std::string getMessage() override;
+        std::string file_path;
+        std::string glaze_message;
+};
+
 struct XMLDeserializeError : BaseError {
         XMLDeserializeError(std::string file_path, std::string pugixml_message);
         std::string getMessage() override;
@@ -75,10 +82,19 @@ struct LevelSetupError : BaseError {
         std::string setup_error;
 };
 
+struct BufferReadError : BaseError {
+        BufferReadError(size_t offset, size_t size, size_t buffer_size);
+        std::string getMessage() override;
+        size_t offset;
+        size_t size;
+        size_t buffer_size;
+};
+
 using Error =
-    std::variant<JSONDeserializeError, XMLDeserializeError,
-                 ResourceNotFoundError, FileOpenError, FileDecompressionError,
-                 GooBallSetupError, LevelSetupError>;
+    std::variant<JSONDeserializeError, BEVEDeserializeError,
+                 XMLDeserializeError, ResourceNotFoundError, FileOpenError,
+                 FileDecompressionError, GooBallSetupError, LevelSetupError,
+                 BufferReadError>;
 
 } // namespace gooforge
 
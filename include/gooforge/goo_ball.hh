@@ -20,6 +20,7 @@
 #ifndef GOOFORGE_GOO_BALL_HH
 #define GOOFORGE_GOO_BALL_HH
 
+#include <optional>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -130,7 +131,9 @@ struct BallTemplateColorInfo {
         unsigned int color;
 };
 
-struct BallTemplateBallPartInfo {
+// everything a ball part can have, see BallTemplateBallPartInfo for what the
+// editor reads
+struct FullBallTemplateBallPartInfo {
         std::string name;
         std::vector<BallTemplateBallPartImageInfo> images;
         std::vector<BallTemplateImageIdInfo> imageBackgroundIds;
@@ -182,7 +185,9 @@ struct BallTemplateBodyPartNameInfo {
         std::string partName;
 };
 
-struct BallTemplateInfo {
+// everything a ball template can have, this is only read by
+// BallTemplateResource::getFull
+struct FullBallTemplateInfo {
         std::string name;
         float width;
         float height;
@@ -329,13 +334,30 @@ struct BallTemplateInfo {
         BallTemplateAttenuationFuncInfo dropAttenuationFunc;
         BallTemplateAttenuationFuncInfo dragAttenuationFunc;
         BallTemplateAttenuationFuncInfo spawnAttenuationFunc;*/
-        std::vector<BallTemplateBallPartInfo> ballParts;
+        std::vector<FullBallTemplateBallPartInfo> ballParts;
         BallTemplateBodyPartNameInfo bodyPart;
         // std::vector<BallTemplateStateAnimationInfo> stateAnimations; // TODO:
         // implement?
         //  TODO: implement the rest of this?
 };
 
+struct BallTemplateBallPartInfo {
+        std::string name;
+        std::vector<BallTemplateBallPartImageInfo> images;
+        float scale;
+};
+
+// just the fields the editor uses, glaze skips over the rest of the file
+// (most of it) without building anything
+struct BallTemplateInfo {
+        float width;
+        float sizeVariance;
+        float strandThickness;
+        BallTemplateImageIdInfo strandImageId;
+        std::vector<BallTemplateBallPartInfo> ballParts;
+        BallTemplateBodyPartNameInfo bodyPart;
+};
+
 struct GooBallInfo {
         GooBallType typeEnum = GooBallType::COMMON;
         int uid = 0;
@@ -362,12 +384,27 @@ struct GooBallInfo {
         float detonationForce = -1.0f;
 };
 
+// everything a ball is built from, found by GooBall::resolve
+struct GooBallResources {
+        BallTemplateResource* template_resource = nullptr;
+        BallTemplateInfo* ball_template = nullptr;
+        BallTemplateBallPartInfo* body_part = nullptr;
+        SpriteResource* sprite_resource = nullptr;
+};
+
 class GooBall : public Entity {
     public:
         GooBall() : Entity(EntityType::GOO_BALL) {}
         ~GooBall() override;
+        // only reads what's already loaded so it can run off the main
+        // thread, nullopt if anything is missing
+        static std::optional<GooBallResources> resolve(
+            const GooBallInfo& info);
         std::expected<void, Error> setup(Level* level, GooBallInfo info,
                                          TerrainGroup* terrain_group);
+        std::expected<void, Error> setup(Level* level, GooBallInfo info,
+                                         TerrainGroup* terrain_group,
+                                         const GooBallResources& resources);
         std::expected<void, Error> refresh() override;
         void update() override;
         void draw(sf::RenderWindow* window) override;
@@ -384,6 +421,8 @@ class GooBall : public Entity {
         BallTemplateInfo* getTemplate();
         TerrainGroup* getTerrainGroup();
         void setTerrainGroup(TerrainGroup* terrain_group);
+        static std::string getBodyPartImageId(
+            GooBallType type, const BallTemplateBallPartInfo& part);
         static std::unordered_map<std::string, GooBallType> ball_name_to_type;
         static std::unordered_map<GooBallType, std::string> ball_type_to_name;
         std::unordered_set<GooStrand*> getStrands();
@@ -391,8 +430,9 @@ class GooBall : public Entity {
         void notifyRemoveStrand(GooStrand* strand) override;
 
     private:
-        Level* level;
-        TerrainGroup* terrain_group;
+        std::expected<void, Error> link(const GooBallResources& resources);
+        Level* level = nullptr;
+        TerrainGroup* terrain_group = nullptr;
         GooBallInfo info;
         BallTemplateInfo* ball_template = nullptr;
         BallTemplateBallPartInfo* body_part = nullptr;
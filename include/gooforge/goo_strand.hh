@@ -34,13 +34,27 @@ struct GooStrandInfo {
         bool filled = true;
 };
 
+// everything a strand is built from, found by GooStrand::resolve
+struct GooStrandResources {
+        BallTemplateResource* template_resource = nullptr;
+        BallTemplateInfo* ball_template = nullptr;
+        SpriteResource* sprite_resource = nullptr;
+};
+
 class GooStrand : public Entity {
     public:
         GooStrand() : Entity(EntityType::GOO_STRAND) {}
         ~GooStrand() override;
+        // only reads what's already loaded so it can run off the main
+        // thread, nullopt if anything is missing
+        static std::optional<GooStrandResources> resolve(
+            const GooStrandInfo& info);
         std::expected<void, Error> setup(GooStrandInfo info,
                                          GooBall* ball1,
                                          GooBall* ball2);
+        std::expected<void, Error> setup(GooStrandInfo info, GooBall* ball1,
+                                         GooBall* ball2,
+                                         const GooStrandResources& resources);
         std::expected<void, Error> refresh() override;
         sf::Sprite getThumbnail() override;
         std::string getDisplayName() override;
@@ -52,6 +66,7 @@ class GooStrand : public Entity {
         void draw(sf::RenderWindow* window) override;
 
     private:
+        std::expected<void, Error> link(const GooStrandResources& resources);
         GooBall* ball1;
         GooBall* ball2;
         GooStrandInfo info;
@@ -0,0 +1,117 @@
+// codeshaunted - gooforge
+// include/gooforge/inventory_snapshot.hh
+// contains InventorySnapshot declarations
+// Copyright (C) 2024 codeshaunted
+//
+// This file is part of gooforge.
+// gooforge is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// gooforge is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with gooforge. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GOOFORGE_INVENTORY_SNAPSHOT_HH
+#define GOOFORGE_INVENTORY_SNAPSHOT_HH
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "SFML/Graphics.hpp"
+
+#include "error.hh"
+#include "mapped_file.hh"
+
+namespace gooforge {
+
+#define GOOFORGE_INVENTORY_SNAPSHOT_MAGIC 0x49544647 // "GFTI"
+#define GOOFORGE_INVENTORY_SNAPSHOT_VERSION 3
+
+enum class InventoryEntryType : uint8_t {
+    SPRITE,
+    ATLAS_SPRITE,
+    ITEM,
+    ITEM_CATALOG,
+};
+
+// a resource as it was recorded, the views point into the snapshot. catalog
+// entries are keyed by the item's uuid and don't have a path
+struct InventoryEntry {
+        InventoryEntryType type;
+        std::string_view id;
+        std::string_view path;
+        sf::IntRect atlas_rect;
+        std::string_view name;
+        std::string_view category;
+        std::string_view thumbnail_id;
+        uint32_t item_type = 0;
+};
+
+// what a file or directory looked like when the snapshot was taken
+struct InventoryStamp {
+        std::string path;
+        int64_t write_time = 0;
+        uint64_t size = 0;
+        static std::optional<InventoryStamp> take(
+            const std::filesystem::path& path);
+        bool operator==(const InventoryStamp& other) const = default;
+};
+
+// every resource manifest found in an install along with the resources each
+// one declared, so an unchanged install doesn't have to be walked or parsed
+class InventorySnapshot {
+    public:
+        static std::optional<InventorySnapshot> load(
+            const std::filesystem::path& path);
+        const std::string& getBasePath() const;
+        const std::vector<InventoryStamp>& getDirectories() const;
+        const std::vector<InventoryStamp>& getManifests() const;
+        // index of the manifest recorded with exactly this stamp
+        std::optional<size_t> findManifest(const InventoryStamp& stamp) const;
+        std::expected<std::vector<InventoryEntry>, Error> getEntries(
+            size_t manifest_index) const;
+
+    private:
+        MappedFile file;
+        std::string base_path;
+        std::vector<InventoryStamp> directories;
+        std::vector<InventoryStamp> manifests;
+        // where the entries of each manifest start in the file
+        std::vector<size_t> entry_offsets;
+        std::unordered_map<std::string, size_t> manifest_indices;
+};
+
+class InventorySnapshotWriter {
+    public:
+        InventorySnapshotWriter(std::string base_path)
+            : base_path(base_path) {}
+        void addDirectory(const InventoryStamp& stamp);
+        void addManifest(const InventoryStamp& stamp,
+                         const std::vector<InventoryEntry>& entries);
+        // written to a temporary file and renamed into place
+        std::expected<void, Error> write(
+            const std::filesystem::path& path) const;
+
+    private:
+        std::string base_path;
+        uint32_t directory_count = 0;
+        uint32_t manifest_count = 0;
+        std::string directories;
+        std::string manifests;
+};
+
+} // namespace gooforge
+
+#endif // GOOFORGE_INVENTORY_SNAPSHOT_HH
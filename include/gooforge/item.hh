@@ -20,6 +20,7 @@
 #ifndef GOOFORGE_ITEM_HH
 #define GOOFORGE_ITEM_HH
 
+#include <optional>
 #include <unordered_map>
 
 #include "entity.hh"
@@ -277,12 +278,26 @@ static std::unordered_map<LiquidType, std::string> liquid_type_to_name =
         {LiquidType::JELLY_BLOCK_SOFT, "Jelly Block Soft"},
 };
 
+// everything an item instance is built from, found by ItemInstance::resolve
+struct ItemInstanceResources {
+        ItemResource* item_resource = nullptr;
+        ItemInfoFile* info_file = nullptr;
+        ItemObjectInfo* object_info = nullptr;
+        SpriteResource* sprite_resource = nullptr;
+};
+
 class ItemInstance : public Entity {
     public:
         ItemInstance() : Entity(EntityType::ITEM_INSTANCE) {}
         ~ItemInstance() override;
         static std::unordered_map<ItemType, std::string> item_type_to_name;
+        // only reads what's already loaded so it can run off the main
+        // thread, nullopt if anything is missing
+        static std::optional<ItemInstanceResources> resolve(
+            const ItemInstanceInfo& info);
         std::expected<void, Error> setup(ItemInstanceInfo info);
+        std::expected<void, Error> setup(
+            ItemInstanceInfo info, const ItemInstanceResources& resources);
         std::expected<void, Error> refresh() override;
         void update() override;
         void draw(sf::RenderWindow* window) override;
@@ -312,6 +327,8 @@ class ItemInstance : public Entity {
             std::vector<ItemInstanceUserVariableInfo> values);
 
     private:
+        std::expected<void, Error> link(
+            const ItemInstanceResources& resources);
         ItemInstanceInfo info;
         ItemInfoFile* info_file;
         ItemObjectInfo* object_info;
@@ -327,6 +344,7 @@ T ItemInstance::getUserVariableValue(size_t index) {
 template <typename T>
 void ItemInstance::setUserVariableValue(size_t index, T value) {
     this->info.userVariables[index].value = float(value);
+    this->markInfoDirty();
 }
 
 } // namespace gooforge
@@ -0,0 +1,98 @@
+// codeshaunted - gooforge
+// include/gooforge/item_catalog.hh
+// contains ItemCatalog declarations
+// Copyright (C) 2024 codeshaunted
+//
+// This file is part of gooforge.
+// gooforge is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// gooforge is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with gooforge. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GOOFORGE_ITEM_CATALOG_HH
+#define GOOFORGE_ITEM_CATALOG_HH
+
+#include <atomic>
+#include <deque>
+#include <expected>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "error.hh"
+#include "item.hh"
+#include "string_hash.hh"
+
+namespace gooforge {
+
+// the handful of fields the editor needs to list an item, so picking an item
+// doesn't require loading its whole ItemInfoFile
+struct ItemCatalogEntry {
+        std::string uuid;
+        std::string name;
+        std::string category;
+        ItemType type = ItemType::INVALID;
+        // sprite id of the item's first object
+        std::string thumbnail_id;
+        static std::expected<ItemCatalogEntry, Error> loadFromFile(
+            const std::filesystem::path& path);
+};
+
+// every item in the install, searchable by name or uuid. it's filled in by a
+// background indexer, so searches only see what has been indexed so far
+class ItemCatalog {
+    public:
+        static ItemCatalog* getInstance();
+        // indexes the given item files on the thread pool a few at a time,
+        // reusing entries from cache_path for files that haven't changed and
+        // writing it back once done, an empty cache_path disables the cache
+        void startIndexing(std::vector<std::filesystem::path> item_paths,
+                           std::filesystem::path cache_path);
+        void stopIndexing();
+        bool isIndexing() const;
+        // fraction of the item files indexed so far
+        float getProgress() const;
+        void add(ItemCatalogEntry entry);
+        void clear();
+        size_t getSize() const;
+        // entries are never moved once added, so the pointers stay valid
+        // while indexing keeps going
+        const ItemCatalogEntry* find(std::string_view uuid) const;
+        // case insensitive, matches a substring of the name or a prefix of
+        // the uuid, an empty filter matches everything
+        std::vector<const ItemCatalogEntry*> search(std::string_view filter,
+                                                    size_t limit = 0) const;
+
+    private:
+        static ItemCatalog* instance;
+        mutable std::mutex mutex;
+        std::deque<ItemCatalogEntry> entries;
+        // lowercased names, kept next to entries so searching doesn't have to
+        // lowercase every name every time
+        std::deque<std::string> search_names;
+        std::unordered_map<std::string, size_t, StringHash, std::equal_to<>>
+            uuid_indices;
+        std::thread indexer;
+        std::atomic<bool> indexing = false;
+        std::atomic<bool> stopping = false;
+        std::atomic<size_t> indexed_count = 0;
+        std::atomic<size_t> total_count = 0;
+        void index(std::vector<std::filesystem::path> item_paths,
+                   std::filesystem::path cache_path);
+};
+
+} // namespace gooforge
+
+#endif // GOOFORGE_ITEM_CATALOG_HH
@@ -22,6 +22,8 @@
 
 #include <expected>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "error.hh"
 #include "goo_ball.hh"
@@ -32,6 +34,10 @@
 
 namespace gooforge {
 
+class LevelStream;
+struct LevelLoadChunk;
+struct LevelJournalRecord;
+
 struct PinInfo {
         unsigned int uid;
         Vector2f pos;
@@ -108,13 +114,32 @@ class Level {
     public:
         ~Level();
         std::expected<void, Error> setup(LevelInfo info);
+        // takes ownership of the stream, its entities are added by loadNext
+        void beginLoad(LevelStream* stream);
+        // works on the next max_entities entities without waiting on the
+        // pool, adding them once they're resolved. returns true once the
+        // whole level is loaded
+        std::expected<bool, Error> loadNext(size_t max_entities);
+        bool isLoading() const;
+        float getLoadProgress() const;
         void update();
         void draw(sf::RenderWindow* window);
         static sf::Vector2f worldToScreen(Vector2f world);
         static Vector2f screenToWorld(sf::Vector2f screen);
         static float radiansToDegrees(float radians);
         static float degreesToRadians(float degrees);
+        // brings info up to date with the entities, only copying the ones that
+        // changed since the last call. entities added or removed since then
+        // were already appended or swapped out of it
         LevelInfo& getInfo();
+        // rebuilds info from scratch, so it's in depth order and its uids
+        // are numbered without gaps again
+        LevelInfo& getExportInfo();
+        // the edits made since the last call, for the journal
+        std::vector<LevelJournalRecord> takeJournalRecords();
+        // renumbers the entities for a new journal on top of info as it was
+        // last returned by getInfo, which is about to be saved
+        void rebaseJournal();
         void removeEntity(Entity* entity);
         void addEntity(Entity* entity);
         void addBall(GooBall* ball);
@@ -125,11 +150,49 @@ class Level {
         void updateStrand(GooStrand* strand);
 
     private:
+        std::expected<LevelLoadChunk*, Error> takeLoadChunk(
+            size_t max_entities);
+        bool advanceLoadChunk();
+        std::expected<void, Error> linkLoadChunk();
+        void insertEntity(Entity* entity);
+        void eraseEntity(Entity* entity);
+        void markInfoDirty(Entity* entity);
+        void rebuildInfo();
+        void updateInfo(Entity* entity);
+        void appendInfo(Entity* entity);
+        void removeInfo(Entity* entity);
+        int getTerrainGroupIndex(TerrainGroup* terrain_group) const;
         LevelInfo info;
+        LevelStream* stream = nullptr;
+        // the entities loadNext is working on, nullptr between chunks
+        LevelLoadChunk* load_chunk = nullptr;
+        // what the balls and strands still being loaded refer to
+        std::vector<TerrainGroup*> loaded_terrain_groups;
+        std::unordered_map<int, GooBall*> loaded_balls;
+        size_t loaded_ball_count = 0;
         std::set<Entity*, EntityDepthComparator> entities;
-        bool entities_dirty = false;
+        // info hasn't been built yet
+        bool entities_dirty = true;
+        // where each entity's info is in info's arrays, the same index is
+        // used for a ball's terrainBalls entry
+        std::unordered_map<Entity*, size_t> info_indices;
+        // the entity at each index of info's arrays, by type
+        std::unordered_map<EntityType, std::vector<Entity*>> info_entities;
+        // the uid the next ball or item added gets
+        int info_next_uid = 0;
+        std::unordered_set<Entity*> dirty_entities;
+        // bumped by rebaseJournal, entities numbered before it get numbered
+        // again when they're next added
+        uint64_t journal_generation = 1;
+        // the number the next entity of each type gets
+        std::unordered_map<EntityType, size_t> journal_next_indices;
+        // edits not yet taken by takeJournalRecords, removals are kept by
+        // number since the entity may be deleted by then
+        std::unordered_set<Entity*> journal_entities;
+        std::vector<std::pair<EntityType, size_t>> journal_removals;
 
         friend class Editor;
+        friend class Entity;
 };
 
 } // namespace gooforge
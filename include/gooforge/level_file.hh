@@ -0,0 +1,177 @@
+// codeshaunted - gooforge
+// include/gooforge/level_file.hh
+// contains LevelFile and LevelStream declarations
+// Copyright (C) 2024 codeshaunted
+//
+// This file is part of gooforge.
+// gooforge is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// gooforge is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with gooforge. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GOOFORGE_LEVEL_FILE_HH
+#define GOOFORGE_LEVEL_FILE_HH
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "error.hh"
+#include "inventory_snapshot.hh"
+#include "level.hh"
+
+namespace gooforge {
+
+#define GOOFORGE_LEVEL_BINARY_EXTENSION ".beve"
+#define GOOFORGE_LEVEL_AUTOSAVE_EXTENSION ".autosave"
+#define GOOFORGE_LEVEL_BINARY_VERSION 1
+
+// what's in a binary copy. it's only read in place of the json when the json
+// still looks the way it did when the copy was written, however its write
+// time compares
+struct LevelBinaryInfo {
+        uint32_t version = GOOFORGE_LEVEL_BINARY_VERSION;
+        std::optional<InventoryStamp> source;
+        // whether the json was written along with this copy
+        bool exported = false;
+        LevelInfo level;
+};
+
+template <typename T>
+struct LevelStreamArray {
+        // views of each element's json, parsed as they're taken
+        std::vector<std::string_view> elements;
+        // or elements that were already read from the binary copy
+        std::vector<T> infos;
+        size_t next = 0;
+        size_t getSize() const {
+            return std::max(this->elements.size(), this->infos.size());
+        }
+};
+
+// a level handed out a few entities at a time. everything but the entity
+// arrays is read up front, the arrays are only split into their elements,
+// each of which is parsed when it's taken
+class LevelStream {
+    public:
+        static LevelStream* fromInfo(LevelInfo info);
+        // the level without its items, terrain groups, balls or strands
+        LevelInfo& getInfo();
+        template <typename T>
+        size_t getRemaining() const;
+        size_t getSize() const;
+        size_t getTakenCount() const;
+        // false when the level has changes the json doesn't have yet
+        bool isExported() const;
+        template <typename T>
+        std::expected<std::vector<T>, Error> take(size_t max_count);
+
+    private:
+        std::string path;
+        // the whole json, the element views point into it
+        std::string buffer;
+        LevelInfo info;
+        bool exported = true;
+        LevelStreamArray<ItemInstanceInfo> items;
+        LevelStreamArray<TerrainGroupInfo> terrain_groups;
+        LevelStreamArray<GooBallInfo> balls;
+        LevelStreamArray<GooStrandInfo> strands;
+        template <typename T>
+        LevelStreamArray<T>& getArray();
+        template <typename T>
+        const LevelStreamArray<T>& getArray() const;
+
+        friend class LevelFile;
+};
+
+// reads and writes levels. next to each .wog2 the editor keeps a binary (beve)
+// copy of the same LevelInfo, which is much faster to read and write than the
+// game's prettified json, so the json only has to be written on export.
+// saving doesn't touch anything but the info it's given, so it can run off
+// the main thread on a copy of the level's info. each file is written next to
+// where it goes and renamed over it, so a failed save leaves the old file
+// alone. progress, if given, goes from 0 to 1 as the files are written
+class LevelFile {
+    public:
+        // reads the binary copy if the json hasn't been replaced since it was
+        // written, otherwise streams the json. if there's a journal of
+        // unsaved edits, its base is read instead with the edits replayed on
+        // top
+        static std::expected<LevelStream*, Error> open(
+            const std::filesystem::path& path);
+        // only writes the binary copy, the json is left for exportJSON
+        static std::expected<void, Error> save(
+            const LevelInfo& info, const std::filesystem::path& path,
+            std::atomic<float>* progress = nullptr);
+        // writes the json the game reads, along with a binary copy so the
+        // json doesn't look newer the next time the level is opened
+        static std::expected<void, Error> exportJSON(
+            const LevelInfo& info, const std::filesystem::path& path,
+            std::atomic<float>* progress = nullptr);
+        // writes a binary copy for the journal to be written on top of,
+        // which is only ever read back when recovering from a crash
+        static std::expected<void, Error> autosave(
+            const LevelInfo& info, const std::filesystem::path& path,
+            std::atomic<float>* progress = nullptr);
+        static std::filesystem::path getBinaryPath(
+            const std::filesystem::path& path);
+        static std::filesystem::path getAutosavePath(
+            const std::filesystem::path& path);
+
+    private:
+        static std::expected<LevelStream*, Error> openJSON(
+            const std::filesystem::path& path);
+        static std::expected<LevelBinaryInfo, Error> loadBinary(
+            const std::filesystem::path& path);
+        // path is the json the copy goes with
+        static std::expected<void, Error> saveBinary(
+            const LevelInfo& info, const std::filesystem::path& path,
+            const std::filesystem::path& binary_path, bool exported);
+        static std::expected<void, Error> writeFile(
+            const std::filesystem::path& path, std::string_view buffer);
+};
+
+template <typename T>
+size_t LevelStream::getRemaining() const {
+    const LevelStreamArray<T>& array = this->getArray<T>();
+
+    return array.getSize() - array.next;
+}
+
+template <typename T>
+LevelStreamArray<T>& LevelStream::getArray() {
+    if constexpr (std::is_same_v<T, ItemInstanceInfo>) {
+        return this->items;
+    } else if constexpr (std::is_same_v<T, TerrainGroupInfo>) {
+        return this->terrain_groups;
+    } else if constexpr (std::is_same_v<T, GooBallInfo>) {
+        return this->balls;
+    } else {
+        static_assert(std::is_same_v<T, GooStrandInfo>);
+        return this->strands;
+    }
+}
+
+template <typename T>
+const LevelStreamArray<T>& LevelStream::getArray() const {
+    return const_cast<LevelStream*>(this)->getArray<T>();
+}
+
+} // namespace gooforge
+
+#endif // GOOFORGE_LEVEL_FILE_HH
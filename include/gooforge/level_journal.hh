@@ -0,0 +1,114 @@
+// codeshaunted - gooforge
+// include/gooforge/level_journal.hh
+// contains LevelJournal declarations
+// Copyright (C) 2024 codeshaunted
+//
+// This file is part of gooforge.
+// gooforge is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// gooforge is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with gooforge. If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef GOOFORGE_LEVEL_JOURNAL_HH
+#define GOOFORGE_LEVEL_JOURNAL_HH
+
+#include <cstdint>
+#include <cstdio>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "error.hh"
+#include "inventory_snapshot.hh"
+#include "level.hh"
+
+namespace gooforge {
+
+#define GOOFORGE_LEVEL_JOURNAL_EXTENSION ".journal"
+#define GOOFORGE_LEVEL_JOURNAL_VERSION 2
+
+// one entity added, changed or removed. entities are numbered per type by
+// where they are in the file the journal is written on top of, with the ones
+// added since numbered after those
+struct LevelJournalRecord {
+        int entityType = 0;
+        uint64_t index = 0;
+        bool removed = false;
+        // only the one matching entityType is set, unless removed
+        std::optional<GooBallInfo> ball;
+        std::optional<GooStrandInfo> strand;
+        std::optional<ItemInstanceInfo> item;
+        std::optional<TerrainGroupInfo> terrainGroup;
+        // what the entity refers to, numbered the same way, -1 for nothing
+        int64_t terrainGroupIndex = -1;
+        int64_t ball1Index = -1;
+        int64_t ball2Index = -1;
+};
+
+struct LevelJournalHeader {
+        uint32_t version = GOOFORGE_LEVEL_JOURNAL_VERSION;
+        // the saved level the records apply to, as it was when it was written
+        InventoryStamp base;
+};
+
+// append-only log of the edits made since the level was last written out in
+// full, so they can be replayed on top of it after a crash. each record is
+// its size and a crc followed by its beve, so a record cut off or garbled by
+// a crash is dropped along with anything after it
+class LevelJournal {
+    public:
+        ~LevelJournal();
+        static std::filesystem::path getPath(
+            const std::filesystem::path& level_path);
+        // replaces any journal at path with an empty one on top of the saved
+        // level at base_path, then writes out anything recorded so far
+        std::expected<void, Error>
+        begin(const std::filesystem::path& path,
+              const std::filesystem::path& base_path);
+        // drops whatever hasn't been flushed, for when it's covered by a save
+        // that's about to be written. records appended while closed are
+        // written out by the next begin
+        void close();
+        // deletes the journal, for when its edits are being thrown away
+        void discard();
+        // closes the journal but leaves it for the next open to replay
+        void release();
+        bool isOpen() const;
+        // whether begin has been called since the last discard
+        bool hasStarted() const;
+        void append(const std::vector<LevelJournalRecord>& records);
+        // writes out what's been appended since the last flush and waits for
+        // it to reach the disk
+        std::expected<void, Error> flush();
+        size_t getSize() const;
+        // applies the journal at path to info, which has to have been read
+        // from the journal's base. returns false without touching info when
+        // there's no journal or it was written on top of something else
+        static std::expected<bool, Error> replay(
+            const std::filesystem::path& path, LevelInfo& info);
+        static std::optional<LevelJournalHeader> readHeader(
+            const std::filesystem::path& path);
+
+    private:
+        std::FILE* file = nullptr;
+        std::filesystem::path path;
+        // framed records that haven't been written yet
+        std::string pending;
+        size_t size = 0;
+        static void appendFrame(std::string& buffer, std::string_view frame);
+};
+
+} // namespace gooforge
+
+#endif // GOOFORGE_LEVEL_JOURNAL_HH
@@ -0,0 +1,53 @@
+// codeshaunted - gooforge
+// include/gooforge/mapped_file.hh
+// contains MappedFile declarations
+// Copyright (C) 2024 codeshaunted
+//
+// This file is part of gooforge.
+// gooforge is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// gooforge is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with gooforge. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GOOFORGE_MAPPED_FILE_HH
+#define GOOFORGE_MAPPED_FILE_HH
+
+#include <expected>
+#include <filesystem>
+
+#include "error.hh"
+
+namespace gooforge {
+
+// read-only view of a whole file mapped into memory, the data stays valid for
+// as long as the MappedFile is alive
+class MappedFile {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        ~MappedFile();
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        static std::expected<MappedFile, Error> open(
+            const std::filesystem::path& path);
+        const char* getData() const;
+        size_t getSize() const;
+
+    private:
+        void close();
+        const char* data = nullptr;
+        size_t size = 0;
+};
+
+} // namespace gooforge
+
+#endif // GOOFORGE_MAPPED_FILE_HH
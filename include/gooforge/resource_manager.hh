@@ -22,27 +22,54 @@
 
 #include <expected>
 #include <filesystem>
+#include <future>
+#include <mutex>
+#include <optional>
 #include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "SFML/Graphics.hpp"
 
+#include "boy_image.hh"
+#include "constants.hh"
 #include "error.hh"
 #include "goo_ball.hh"
+#include "inventory_snapshot.hh"
 #include "item.hh"
+#include "item_catalog.hh"
+#include "resource_watcher.hh"
+#include "string_hash.hh"
 #include "terrain.hh"
 
 namespace gooforge {
 
 enum class ResourceType {
     SPRITE,
+    BALL_TEMPLATE,
+    ITEM,
+    TERRAIN_TEMPLATES,
 };
 
 class BaseResource {
     public:
         BaseResource(std::string path) : path(path) {}
+        BaseResource(const BaseResource&) = default;
+        BaseResource(BaseResource&&) = default;
         virtual ~BaseResource();
+        BaseResource& operator=(const BaseResource&) = default;
+        BaseResource& operator=(BaseResource&&) = default;
         virtual void unload() {}
+        virtual bool isLoaded() const { return false; }
+        // reads the changed file again, keeping the old contents if that
+        // fails
+        virtual std::expected<void, Error> reload() {
+            return std::expected<void, Error>{};
+        }
+        const std::string& getPath() const;
 
     protected:
         std::string path;
@@ -57,9 +84,31 @@ class SpriteResource : public BaseResource {
               atlas_rect(atlas_rect) {}
         std::expected<sf::Sprite, Error> get();
         void unload() override;
+        SpriteResource* getTextureResource();
+        void evict();
+        void touch();
+        size_t getByteSize() const;
+        uint64_t getLastUsedFrame() const;
+        bool isLoaded() const override;
+        std::expected<void, Error> reload() override;
+        bool isReady();
+        bool isAtlasSprite() const;
+        sf::IntRect getAtlasRect() const;
+        const sf::Texture* getTexture() const;
+        std::expected<BoyImage, Error> decode() const;
+        void upload(const BoyImage& image);
+        // for a decode that failed off the main thread, get() hands the
+        // error back from then on like a synchronous decode would have
+        void fail(Error error);
 
     private:
         sf::Texture* texture = nullptr;
+        bool loaded = false;
+        bool loading = false;
+        // cleared by unload, so the file is tried again once it's reopened
+        std::optional<Error> decode_error;
+        size_t byte_size = 0;
+        uint64_t last_used_frame = 0;
         bool atlas_sprite = false;
         sf::IntRect atlas_rect;
 };
@@ -68,71 +117,262 @@ class BallTemplateResource : public BaseResource {
     public:
         BallTemplateResource(std::string path) : BaseResource(path) {}
         std::expected<BallTemplateInfo*, Error> get();
+        // nullptr until get has parsed it, never parses
+        BallTemplateInfo* getLoaded() const;
+        // every field in the file, parsed separately the first time it's
+        // asked for
+        std::expected<FullBallTemplateInfo*, Error> getFull();
         void unload() override;
+        bool isLoaded() const override;
+        std::expected<void, Error> reload() override;
 
     private:
         BallTemplateInfo* info = nullptr;
+        FullBallTemplateInfo* full_info = nullptr;
+        // replaced by reload, kept until unload in case an entity fails to
+        // refresh and is left pointing into them
+        std::vector<BallTemplateInfo*> previous_infos;
+        std::vector<FullBallTemplateInfo*> previous_full_infos;
 };
 
 class ItemResource : public BaseResource {
     public:
         ItemResource(std::string path) : BaseResource(path) {}
         std::expected<ItemInfoFile*, Error> get();
+        // nullptr until get has parsed it, never parses
+        ItemInfoFile* getLoaded() const;
         void unload() override;
+        bool isLoaded() const override;
+        std::expected<void, Error> reload() override;
 
     private:
         ItemInfoFile* info_file = nullptr;
+        // replaced by reload, kept until unload in case an entity fails to
+        // refresh and is left pointing into them
+        std::vector<ItemInfoFile*> previous_info_files;
 };
 
 class TerrainTemplatesResource : public BaseResource {
     public:
         TerrainTemplatesResource(std::string path) : BaseResource(path) {}
         std::expected<TerrainTemplateInfoFile*, Error> get();
+        // nullptr until get has parsed it, never parses
+        TerrainTemplateInfoFile* getLoaded() const;
         void unload() override;
 
     private:
         TerrainTemplateInfoFile* info_file = nullptr;
 };
 
-using Resource = std::variant<SpriteResource, BallTemplateResource,
-                              ItemResource, TerrainTemplatesResource>;
+// textures being decoded on the pool by ResourceManager::prefetchSprites,
+// uploaded by finishPrefetch
+struct SpritePrefetch {
+        std::vector<std::pair<SpriteResource*,
+                              std::future<std::expected<BoyImage, Error>>>>
+            decodes;
+        // every decode is done, so finishPrefetch won't block
+        bool isReady() const;
+        void wait() const;
+};
+
+// where a resource lives in ResourceManager's pools
+struct ResourceHandle {
+        ResourceType type;
+        uint32_t index;
+};
+
+// resources found by the manifest loaders, waiting to be merged into the pools
+struct ResourceList {
+        std::vector<std::pair<std::string, SpriteResource>> sprites;
+        std::vector<std::pair<std::string, ItemResource>> items;
+};
+
+// an item's uuid packed into 128 bits, so looking up an item doesn't have to
+// build or hash a string
+struct ItemKey {
+        uint64_t high = 0;
+        uint64_t low = 0;
+        static std::optional<ItemKey> fromUUID(std::string_view uuid);
+        bool operator==(const ItemKey& other) const = default;
+};
+
+struct ItemKeyHash {
+        size_t operator()(const ItemKey& key) const {
+            return std::hash<uint64_t>{}(key.high ^
+                                         (key.low * 0x9e3779b97f4a7c15ull));
+        }
+};
 
 class ResourceManager {
     public:
         ~ResourceManager();
         static ResourceManager* getInstance();
+        // can only be done once, pointers into the pools are handed out
+        // from then on. asking again for the same install does nothing
         std::expected<void, Error> takeInventory(
             std::filesystem::path& base_path);
+        bool hasInventory() const;
+        const std::filesystem::path& getBasePath() const;
+        void setInventorySnapshotPath(std::filesystem::path path);
+        std::expected<void, Error> loadManifest(
+            const std::filesystem::path& path, ResourceList& resources) const;
         std::expected<void, Error> loadResourceManifest(
-            std::filesystem::path& path);
+            const std::filesystem::path& path, ResourceList& resources) const;
         std::expected<void, Error> loadAtlasManifest(
-            std::filesystem::path& path);
-        template <typename T>
-        std::expected<T*, Error> getResource(std::string id);
+            const std::filesystem::path& path, ResourceList& resources) const;
         template <typename T>
-        std::expected<std::vector<T*>, Error> getResources(
-            std::string filter = "", int limit = -1);
+        std::expected<T*, Error> getResource(std::string_view id);
+        std::expected<BallTemplateResource*, Error> getBallTemplate(
+            GooBallType type);
+        std::expected<ItemResource*, Error> getItem(std::string_view uuid);
+        std::expected<TerrainTemplatesResource*, Error> getTerrainTemplates();
+        SpritePrefetch prefetchSprites(
+            const std::vector<SpriteResource*>& sprite_resources);
+        void finishPrefetch(SpritePrefetch& prefetch);
+        void setAsyncSpriteLoading(bool async);
+        bool getAsyncSpriteLoading() const;
+        const sf::Texture* getPlaceholderTexture();
+        void queueDecode(SpriteResource* sprite_resource);
+        void processUploads(size_t max_uploads);
+        void update();
+        uint64_t getFrame() const;
+        void setTextureBudget(size_t bytes);
+        size_t getTextureBytes() const;
+        SpriteResource* getTextureOwner(const sf::Texture* texture);
+        void trackTexture(SpriteResource* sprite_resource);
+        void untrackTexture(SpriteResource* sprite_resource);
+        void evictTextures();
+        // reloads the loaded resources whose files changed on disk and
+        // refreshes the entities using them
+        void reloadChangedResources();
+        void setEntityResources(Entity* entity,
+                                std::vector<BaseResource*> resources);
+        void removeEntityResources(Entity* entity);
+        const std::unordered_map<const BaseResource*,
+                                 std::unordered_set<Entity*>>&
+        getResourceUsage() const;
+        void refreshResourceUsers(const std::vector<BaseResource*>& resources);
         void unloadAll();
 
     private:
+        struct DecodedSprite {
+                SpriteResource* sprite_resource;
+                size_t generation;
+                std::expected<BoyImage, Error> image;
+        };
+
         static ResourceManager* instance;
         std::filesystem::path base_path;
-        std::unordered_map<std::string, Resource*> resources;
+        // empty when inventory snapshots are disabled
+        std::filesystem::path inventory_snapshot_path;
+        static bool isManifestPath(const std::filesystem::path& path);
+        template <typename T>
+        static constexpr ResourceType getResourceType();
+        template <typename T>
+        std::vector<T>& getPool();
+        template <typename T>
+        T* addResource(std::string id, T resource);
+        BaseResource* getResource(ResourceHandle handle);
+        void indexResourcePaths();
+        static void discoverManifests(
+            const std::filesystem::path& base_path,
+            std::vector<std::filesystem::path>& manifest_paths,
+            std::vector<InventoryStamp>& directories);
+        // one contiguous pool per kind of resource, reserved once by
+        // takeInventory so the pointers handed out never move
+        std::vector<SpriteResource> sprite_pool;
+        std::vector<BallTemplateResource> ball_template_pool;
+        std::vector<ItemResource> item_pool;
+        std::vector<TerrainTemplatesResource> terrain_templates_pool;
+        std::unordered_map<std::string, ResourceHandle, StringHash,
+                           std::equal_to<>>
+            resource_handles;
+        // direct handles to resources that are looked up by something other
+        // than a string, filled in by takeInventory
+        std::vector<BallTemplateResource*> ball_templates;
+        std::unordered_map<ItemKey, ItemResource*, ItemKeyHash> items;
+        TerrainTemplatesResource* terrain_templates = nullptr;
+        // the resources read from each file, for finding what to reload when
+        // the watcher sees a file change. atlas sprites are left out, they're
+        // reloaded through their atlas
+        std::unordered_map<std::string, std::vector<ResourceHandle>,
+                           StringHash, std::equal_to<>>
+            path_handles;
+        ResourceWatcher watcher;
+        // which entities were built from which resources, kept up to date by
+        // the entities' refreshes. entities only held by the undo history are
+        // in here too, so they stay in sync with reloads
+        std::unordered_map<const BaseResource*, std::unordered_set<Entity*>>
+            resource_users;
+        std::unordered_map<Entity*, std::vector<BaseResource*>>
+            entity_resources;
+        bool async_sprite_loading = false;
+        sf::Texture* placeholder_texture = nullptr;
+        // bumped by unloadAll so decodes queued before it get dropped
+        size_t generation = 0;
+        std::mutex decoded_mutex;
+        std::vector<DecodedSprite> decoded_sprites;
+        uint64_t frame = 0;
+        size_t texture_budget =
+            static_cast<size_t>(GOOFORGE_TEXTURE_BUDGET_DEFAULT_MB) * 1024 *
+            1024;
+        size_t texture_bytes = 0;
+        std::unordered_set<SpriteResource*> loaded_textures;
 };
 
 template <typename T>
-std::expected<T*, Error> ResourceManager::getResource(std::string id) {
-    if (!this->resources.contains(id)) {
-        return std::unexpected(ResourceNotFoundError(id));
+std::expected<T*, Error> ResourceManager::getResource(std::string_view id) {
+    auto it = this->resource_handles.find(id);
+    if (it == this->resource_handles.end() ||
+        it->second.type != ResourceManager::getResourceType<T>()) {
+        return std::unexpected(ResourceNotFoundError(std::string(id)));
+    }
+
+    return &this->getPool<T>()[it->second.index];
+}
+
+template <typename T>
+constexpr ResourceType ResourceManager::getResourceType() {
+    if constexpr (std::is_same_v<T, SpriteResource>) {
+        return ResourceType::SPRITE;
+    } else if constexpr (std::is_same_v<T, BallTemplateResource>) {
+        return ResourceType::BALL_TEMPLATE;
+    } else if constexpr (std::is_same_v<T, ItemResource>) {
+        return ResourceType::ITEM;
+    } else {
+        static_assert(std::is_same_v<T, TerrainTemplatesResource>);
+        return ResourceType::TERRAIN_TEMPLATES;
     }
+}
 
-    Resource* resource = this->resources.at(id);
+template <typename T>
+std::vector<T>& ResourceManager::getPool() {
+    if constexpr (std::is_same_v<T, SpriteResource>) {
+        return this->sprite_pool;
+    } else if constexpr (std::is_same_v<T, BallTemplateResource>) {
+        return this->ball_template_pool;
+    } else if constexpr (std::is_same_v<T, ItemResource>) {
+        return this->item_pool;
+    } else {
+        static_assert(std::is_same_v<T, TerrainTemplatesResource>);
+        return this->terrain_templates_pool;
+    }
+}
 
-    if (T* t_resource = std::get_if<T>(resource)) {
-        return t_resource;
+// returns nullptr if the id is already taken, the first definition wins
+template <typename T>
+T* ResourceManager::addResource(std::string id, T resource) {
+    std::vector<T>& pool = this->getPool<T>();
+    auto [it, inserted] = this->resource_handles.insert(
+        {std::move(id), ResourceHandle{ResourceManager::getResourceType<T>(),
+                                       static_cast<uint32_t>(pool.size())}});
+    if (!inserted) {
+        return nullptr;
     }
 
-    return std::unexpected(ResourceNotFoundError(id));
+    pool.push_back(std::move(resource));
+
+    return &pool.back();
 }
 
 } // namespace gooforge
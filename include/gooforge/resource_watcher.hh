@@ -0,0 +1,54 @@
+// codeshaunted - gooforge
+// include/gooforge/resource_watcher.hh
+// contains ResourceWatcher declarations
+// Copyright (C) 2024 codeshaunted
+//
+// This file is part of gooforge.
+// gooforge is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// gooforge is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with gooforge. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GOOFORGE_RESOURCE_WATCHER_HH
+#define GOOFORGE_RESOURCE_WATCHER_HH
+
+#include <filesystem>
+#include <future>
+#include <unordered_map>
+#include <vector>
+
+namespace gooforge {
+
+// reports files written anywhere under a directory tree, so resources can be
+// reloaded as they're edited. only implemented with inotify on linux, on
+// other platforms it never reports anything
+class ResourceWatcher {
+    public:
+        ~ResourceWatcher();
+        // the tree is walked on the thread pool, changes made before the walk
+        // gets to a directory are missed
+        void watch(std::filesystem::path path);
+        void stop();
+        // files written since the last call, each listed once
+        std::vector<std::filesystem::path> poll();
+
+    private:
+        int fd = -1;
+        std::future<void> setup;
+        // watch descriptors to the directories they watch, only touched by
+        // the setup task until it's done and by poll after that
+        std::unordered_map<int, std::filesystem::path> directories;
+        void addDirectory(const std::filesystem::path& path);
+};
+
+} // namespace gooforge
+
+#endif // GOOFORGE_RESOURCE_WATCHER_HH
@@ -0,0 +1,39 @@
+// codeshaunted - gooforge
+// include/gooforge/string_hash.hh
+// contains StringHash declarations
+// Copyright (C) 2024 codeshaunted
+//
+// This file is part of gooforge.
+// gooforge is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// gooforge is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with gooforge. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GOOFORGE_STRING_HASH_HH
+#define GOOFORGE_STRING_HASH_HH
+
+#include <functional>
+#include <string_view>
+
+namespace gooforge {
+
+// lets string keyed maps be searched with a std::string_view without building
+// a std::string first
+struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view string) const {
+            return std::hash<std::string_view>{}(string);
+        }
+};
+
+} // namespace gooforge
+
+#endif // GOOFORGE_STRING_HASH_HH
@@ -21,6 +21,7 @@
 #define GOOFORGE_TERRAIN_HH
 
 #include <expected>
+#include <optional>
 #include <set>
 
 namespace gooforge {
@@ -59,10 +60,24 @@ struct TerrainTemplateInfoFile {
         std::vector<TerrainTemplateInfo> terrainTypes;
 };
 
+// everything a terrain group is built from, found by TerrainGroup::resolve
+struct TerrainGroupResources {
+        TerrainTemplatesResource* templates_resource = nullptr;
+        TerrainTemplateInfo* template_info = nullptr;
+        int type_index = 0;
+        SpriteResource* sprite_resource = nullptr;
+};
+
 class TerrainGroup : public Entity {
     public:
         TerrainGroup() : Entity(EntityType::TERRAIN_GROUP) {}
+        // only reads what's already loaded so it can run off the main
+        // thread, nullopt if anything is missing
+        static std::optional<TerrainGroupResources> resolve(
+            const TerrainGroupInfo& info);
         std::expected<void, Error> setup(TerrainGroupInfo info);
+        std::expected<void, Error> setup(
+            TerrainGroupInfo info, const TerrainGroupResources& resources);
         std::expected<void, Error> refresh();
         void update() override;
         void draw(sf::RenderWindow* window) override;
@@ -80,6 +95,8 @@ class TerrainGroup : public Entity {
         void notifyUpdateStrand(GooStrand* strand) override;
 
     private:
+        std::expected<void, Error> link(
+            const TerrainGroupResources& resources);
         TerrainGroupInfo info;
         TerrainTemplateInfo* template_info;
         std::unordered_set<GooStrand*> terrain_strands;
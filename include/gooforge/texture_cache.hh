@@ -0,0 +1,77 @@
+// codeshaunted - gooforge
+// include/gooforge/texture_cache.hh
+// contains TextureCache declarations
+// Copyright (C) 2024 codeshaunted
+//
+// This file is part of gooforge.
+// gooforge is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// gooforge is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with gooforge. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GOOFORGE_TEXTURE_CACHE_HH
+#define GOOFORGE_TEXTURE_CACHE_HH
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+
+#include "boy_image.hh"
+
+namespace gooforge {
+
+#define GOOFORGE_TEXTURE_CACHE_MAGIC 0x43544647 // "GFTC"
+#define GOOFORGE_TEXTURE_CACHE_VERSION 2
+
+// laid out so the pixels can be used straight out of a mapping of the entry.
+// the header is followed by the source path, padded to 8 bytes, and then the
+// pixels
+struct TextureCacheHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t source_size;
+        int64_t source_write_time;
+        uint32_t width;
+        uint32_t height;
+        uint64_t source_path_size;
+};
+
+// on disk cache of decoded .image files, entries are keyed by the source path,
+// size and write time so a changed source file never hits a stale entry. the
+// key is only a hash, so the path is stored in the entry and checked too
+class TextureCache {
+    public:
+        static TextureCache* getInstance();
+        void enable(std::filesystem::path directory, uint64_t max_size);
+        void disable();
+        bool isEnabled() const;
+        std::optional<BoyImage> load(const std::filesystem::path& source_path);
+        void store(const std::filesystem::path& source_path,
+                   const BoyImage& image);
+        void prune();
+
+    private:
+        static TextureCache* instance;
+        std::filesystem::path directory;
+        uint64_t max_size = 0;
+        std::atomic<bool> enabled = false;
+        std::atomic<uint64_t> size = 0;
+        std::mutex prune_mutex;
+        std::optional<std::filesystem::path> getEntryPath(
+            const std::filesystem::path& source_path,
+            TextureCacheHeader& header);
+};
+
+} // namespace gooforge
+
+#endif // GOOFORGE_TEXTURE_CACHE_HH
@@ -0,0 +1,76 @@
+// codeshaunted - gooforge
+// include/gooforge/thread_pool.hh
+// contains ThreadPool declarations
+// Copyright (C) 2024 codeshaunted
+//
+// This file is part of gooforge.
+// gooforge is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// gooforge is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with gooforge. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GOOFORGE_THREAD_POOL_HH
+#define GOOFORGE_THREAD_POOL_HH
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace gooforge {
+
+// fixed set of worker threads shared by everything that wants to get work off
+// the main thread, tasks must never wait on other tasks in the same pool
+class ThreadPool {
+    public:
+        ThreadPool(size_t thread_count);
+        ~ThreadPool();
+        static ThreadPool* getInstance();
+        template <typename F>
+        std::future<std::invoke_result_t<F>> submit(F task);
+        size_t getThreadCount() const;
+
+    private:
+        static ThreadPool* instance;
+        std::vector<std::thread> threads;
+        std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool stopping = false;
+        void work();
+};
+
+template <typename F>
+std::future<std::invoke_result_t<F>> ThreadPool::submit(F task) {
+    // std::function needs to be copyable, std::packaged_task is not
+    auto packaged_task =
+        std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(
+            std::move(task));
+    auto future = packaged_task->get_future();
+
+    {
+        std::lock_guard lock(this->mutex);
+        this->tasks.push_back([packaged_task] { (*packaged_task)(); });
+    }
+
+    this->condition.notify_one();
+
+    return future;
+}
+
+} // namespace gooforge
+
+#endif // GOOFORGE_THREAD_POOL_HH
@@ -0,0 +1,85 @@
+// codeshaunted - gooforge
+// include/gooforge/thumbnail_atlas.hh
+// contains ThumbnailAtlas declarations
+// Copyright (C) 2024 codeshaunted
+//
+// This file is part of gooforge.
+// gooforge is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// gooforge is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with gooforge. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GOOFORGE_THUMBNAIL_ATLAS_HH
+#define GOOFORGE_THUMBNAIL_ATLAS_HH
+
+#include <deque>
+#include <future>
+#include <map>
+#include <memory>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "SFML/Graphics.hpp"
+
+namespace gooforge {
+
+#define GOOFORGE_THUMBNAIL_SIZE 64
+#define GOOFORGE_THUMBNAIL_ATLAS_SIZE 2048
+#define GOOFORGE_MAX_THUMBNAILS_PER_FRAME 8
+
+// downsampled copies of sprites packed into shared textures, so UI lists can
+// draw all of their icons from a single texture. they're made the first time
+// they're asked for, from pixels decoded again on the pool, so the textures
+// are never read back from the gpu
+class ThumbnailAtlas {
+    public:
+        static ThumbnailAtlas* getInstance();
+        sf::Sprite get(const sf::Sprite& sprite);
+        // starts making the thumbnails asked for since the last call and
+        // copies a limited number of finished ones into the pages
+        void update();
+        void invalidate(const sf::Texture* texture);
+        void clear();
+
+    private:
+        using Key = std::tuple<const sf::Texture*, int, int, int, int>;
+
+        // the thumbnails asked for from one texture, made together so the
+        // texture is only decoded once
+        struct Job {
+                const sf::Texture* texture;
+                // set when the texture changed or went away after the job
+                // started, its thumbnails are thrown away
+                bool stale = false;
+                std::vector<Key> keys;
+                // one per key, empty if it couldn't be made
+                std::future<std::vector<std::vector<uint8_t>>> thumbnails;
+        };
+
+        static ThumbnailAtlas* instance;
+        std::vector<std::unique_ptr<sf::Texture>> pages;
+        std::map<Key, size_t> cells;
+        std::vector<size_t> free_cells;
+        size_t next_cell = 0;
+        // asked for by get since the last update
+        std::set<Key> requested;
+        // in a job or waiting to be copied into a page
+        std::set<Key> pending;
+        std::vector<Job> jobs;
+        std::deque<std::pair<Key, std::vector<uint8_t>>> finished;
+        size_t allocateCell();
+        sf::Sprite getCellSprite(size_t cell);
+};
+
+} // namespace gooforge
+
+#endif // GOOFORGE_THUMBNAIL_ATLAS_HH
@@ -0,0 +1,126 @@
+// codeshaunted - gooforge
+// source/gooforge/benchmark/level_info_benchmark.cc
+// times rebuilding a level's info against updating it incrementally
+// Copyright (C) 2024 codeshaunted
+//
+// This file is part of gooforge.
+// gooforge is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// gooforge is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with gooforge. If not, see <https://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+#include "spdlog.h"
+
+#include "level.hh"
+
+namespace {
+
+// level sizes to time when none are given on the command line
+const std::vector<size_t> default_entity_counts = {1000, 10000, 50000};
+
+// how many times each kind of getInfo is timed, the average is reported
+constexpr size_t rebuild_iterations = 20;
+constexpr size_t update_iterations = 1000;
+
+double getMicroseconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+// a quarter balls and the rest items, neither set up with any resources
+// since getInfo only looks at their info. the balls go in first, adding one
+// tells every entity already in the level about it
+gooforge::GooBall* buildLevel(gooforge::Level& level, size_t entity_count) {
+    gooforge::GooBall* moved_ball = nullptr;
+
+    size_t ball_count = std::max<size_t>(1, entity_count / 4);
+    for (size_t i = 0; i < ball_count; ++i) {
+        auto ball = new gooforge::GooBall();
+        ball->getInfo().pos =
+            gooforge::Vector2f(static_cast<float>(i), 0.0f);
+        level.addEntity(ball);
+        moved_ball = ball;
+    }
+
+    for (size_t i = ball_count; i < entity_count; ++i) {
+        auto item_instance = new gooforge::ItemInstance();
+        item_instance->getInfo().pos =
+            gooforge::Vector2f(0.0f, static_cast<float>(i));
+        level.addEntity(item_instance);
+    }
+
+    return moved_ball;
+}
+
+void runBenchmark(size_t entity_count) {
+    gooforge::Level level;
+    gooforge::GooBall* moved_ball = buildLevel(level, entity_count);
+    level.getInfo();
+
+    std::chrono::steady_clock::duration rebuild_time{};
+    for (size_t i = 0; i < rebuild_iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        level.getExportInfo();
+        rebuild_time += std::chrono::steady_clock::now() - start;
+    }
+
+    // adding an entity only appends it to info
+    std::chrono::steady_clock::duration add_time{};
+    for (size_t i = 0; i < update_iterations; ++i) {
+        auto item_instance = new gooforge::ItemInstance();
+
+        auto start = std::chrono::steady_clock::now();
+        level.addEntity(item_instance);
+        level.getInfo();
+        add_time += std::chrono::steady_clock::now() - start;
+    }
+
+    std::chrono::steady_clock::duration update_time{};
+    for (size_t i = 0; i < update_iterations; ++i) {
+        moved_ball->setPosition(
+            gooforge::Vector2f(static_cast<float>(i), 1.0f));
+
+        auto start = std::chrono::steady_clock::now();
+        level.getInfo();
+        update_time += std::chrono::steady_clock::now() - start;
+    }
+
+    spdlog::info("{} entities: rebuild {:.1f}us, update after one add "
+                 "{:.3f}us, update after one move {:.3f}us",
+                 entity_count,
+                 getMicroseconds(rebuild_time) / rebuild_iterations,
+                 getMicroseconds(add_time) / update_iterations,
+                 getMicroseconds(update_time) / update_iterations);
+}
+
+} // namespace
+
+// entity counts can be passed as arguments, otherwise a few defaults are used
+int main(int argc, char* argv[]) {
+    std::vector<size_t> entity_counts;
+    for (int i = 1; i < argc; ++i) {
+        entity_counts.push_back(std::strtoull(argv[i], nullptr, 10));
+    }
+
+    if (entity_counts.empty()) {
+        entity_counts = default_entity_counts;
+    }
+
+    for (size_t entity_count : entity_counts) {
+        runBenchmark(entity_count);
+    }
+
+    return 0;
+}
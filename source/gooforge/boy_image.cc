@@ -19,68 +19,197 @@
 
 #include "boy_image.hh"
 
-#include <fstream>
-
 #include "zstd.h"
+#include "zstd_errors.h"
 
 #include "buffer_stream.hh"
 
 namespace gooforge {
 
-std::expected<sf::Image, Error> BoyImage::loadFromFile(std::string_view path) {
-    std::ifstream file(path.data(), std::ios::binary | std::ios::ate);
+namespace {
+
+struct DecompressionContextDeleter {
+        void operator()(ZSTD_DCtx* context) const { ZSTD_freeDCtx(context); }
+};
+
+// creating a context is far more expensive than decompressing most of the
+// smaller sprites, so every thread keeps one around and reuses it. nullptr if
+// one couldn't be made, it's tried again on the next call
+ZSTD_DCtx* getThreadDecompressionContext() {
+    thread_local std::unique_ptr<ZSTD_DCtx, DecompressionContextDeleter>
+        context;
+    if (!context) {
+        context.reset(ZSTD_createDCtx());
+        if (!context) {
+            return nullptr;
+        }
+    }
+
+    ZSTD_DCtx_reset(context.get(), ZSTD_reset_session_only);
+
+    return context.get();
+}
+
+// decompresses until output is full, returns a zstd error code on failure.
+// frames are followed one after another, so files made of several
+// concatenated (or skippable) frames decode the same as a single frame
+size_t decompressStreamInto(ZSTD_DCtx* context, ZSTD_inBuffer& input,
+                            ZSTD_outBuffer& output) {
+    while (output.pos < output.size) {
+        size_t input_pos = input.pos;
+        size_t output_pos = output.pos;
+
+        size_t result = ZSTD_decompressStream(context, &output, &input);
+        if (ZSTD_isError(result)) {
+            return result;
+        }
+
+        // no progress means we ran out of input before the output was filled
+        if (input.pos == input_pos && output.pos == output_pos) {
+            return static_cast<size_t>(-ZSTD_error_srcSize_wrong);
+        }
+    }
+
+    return 0;
+}
+
+// sums the content sizes of every frame in data, ZSTD_CONTENTSIZE_UNKNOWN if
+// any frame doesn't record one and ZSTD_CONTENTSIZE_ERROR if data is invalid
+unsigned long long getDecompressedSize(const char* data, size_t size) {
+    unsigned long long total = 0;
+
+    while (size > 0) {
+        unsigned long long frame_content_size =
+            ZSTD_getFrameContentSize(data, size);
+        if (frame_content_size == ZSTD_CONTENTSIZE_ERROR) {
+            return ZSTD_CONTENTSIZE_ERROR;
+        }
+
+        if (frame_content_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+            return ZSTD_CONTENTSIZE_UNKNOWN;
+        }
+
+        size_t frame_size = ZSTD_findFrameCompressedSize(data, size);
+        if (ZSTD_isError(frame_size)) {
+            return ZSTD_CONTENTSIZE_ERROR;
+        }
+
+        total += frame_content_size;
+        data += frame_size;
+        size -= frame_size;
+    }
+
+    return total;
+}
+
+} // namespace
+
+std::expected<BoyImage, Error> BoyImage::loadFromFile(std::string_view path) {
+    auto file = MappedFile::open(path);
     if (!file) {
-        return std::unexpected(FileOpenError(std::string(path)));
+        return std::unexpected(file.error());
     }
 
-    size_t file_size = file.tellg();
+    if (file->getSize() < GOOFORGE_BOY_IMAGE_FILE_HEADER_SIZE) {
+        return std::unexpected(FileDecompressionError(
+            std::string(path),
+            static_cast<size_t>(-ZSTD_error_srcSize_wrong)));
+    }
 
-    file.seekg(36); // skip header
-    size_t compressed_data_size = file_size - 36;
-    char* compressed_data = new char[compressed_data_size];
-    file.read(compressed_data, compressed_data_size);
+    ZSTD_DCtx* context = getThreadDecompressionContext();
+    if (!context) {
+        return std::unexpected(FileDecompressionError(
+            std::string(path),
+            static_cast<size_t>(-ZSTD_error_memory_allocation)));
+    }
 
-    file.close();
+    // zstd reads straight out of the mapping, skipping the file header
+    ZSTD_inBuffer input = {
+        file->getData() + GOOFORGE_BOY_IMAGE_FILE_HEADER_SIZE,
+        file->getSize() - GOOFORGE_BOY_IMAGE_FILE_HEADER_SIZE, 0};
 
-    size_t decompressed_size =
-        ZSTD_getFrameContentSize(compressed_data, compressed_data_size);
-    if (ZSTD_isError(decompressed_size)) {
-        delete[] compressed_data;
+    // decompress just the header first so we know how big the image is, the
+    // pixels can then be decompressed straight into their final buffer
+    char header[GOOFORGE_BOY_IMAGE_DATA_HEADER_SIZE];
+    ZSTD_outBuffer header_output = {header, sizeof(header), 0};
+    size_t result = decompressStreamInto(context, input, header_output);
+    if (ZSTD_isError(result)) {
         return std::unexpected(
-            FileDecompressionError(std::string(path), decompressed_size));
+            FileDecompressionError(std::string(path), result));
+    }
+
+    BufferStream stream(header, sizeof(header));
+    stream.seek(36); // skip first part of header
+
+    BoyImage image;
+    image.width = stream.read<uint32_t>();
+    image.height = stream.read<uint32_t>();
+    // the rest of the header is unused
+
+    // the header can't be trusted to size the allocation below, the frames
+    // may not say how much data there really is
+    if (image.width == 0 || image.height == 0 ||
+        image.width > GOOFORGE_BOY_IMAGE_MAX_SIZE ||
+        image.height > GOOFORGE_BOY_IMAGE_MAX_SIZE ||
+        image.width > SIZE_MAX / 4 / image.height) {
+        return std::unexpected(FileDecompressionError(
+            std::string(path),
+            static_cast<size_t>(-ZSTD_error_corruption_detected)));
+    }
+
+    // frames don't have to record their content size, but when every one of
+    // them does we can reject a bogus header before allocating for it
+    unsigned long long content_size = getDecompressedSize(
+        file->getData() + GOOFORGE_BOY_IMAGE_FILE_HEADER_SIZE,
+        file->getSize() - GOOFORGE_BOY_IMAGE_FILE_HEADER_SIZE);
+    if (content_size == ZSTD_CONTENTSIZE_ERROR) {
+        return std::unexpected(FileDecompressionError(
+            std::string(path),
+            static_cast<size_t>(-ZSTD_error_corruption_detected)));
     }
 
-    // some files wont decompress with the getFrameContentSize result...
-    // for now just do decompressed_size * 2, TODO: switch to stream
-    // decompression
-    uint8_t* decompressed_data = new uint8_t[decompressed_size * 2];
-    size_t result = ZSTD_decompress(decompressed_data, decompressed_size * 2,
-                                    compressed_data, compressed_data_size);
+    if (content_size != ZSTD_CONTENTSIZE_UNKNOWN &&
+        content_size < GOOFORGE_BOY_IMAGE_DATA_HEADER_SIZE +
+                           static_cast<unsigned long long>(
+                               image.getPixelsSize())) {
+        return std::unexpected(FileDecompressionError(
+            std::string(path),
+            static_cast<size_t>(-ZSTD_error_srcSize_wrong)));
+    }
+
+    image.owned_pixels.reset(new uint8_t[image.getPixelsSize()]);
+    image.pixels = image.owned_pixels.get();
+    ZSTD_outBuffer pixel_output = {image.owned_pixels.get(),
+                                   image.getPixelsSize(), 0};
+    result = decompressStreamInto(context, input, pixel_output);
     if (ZSTD_isError(result)) {
-        delete[] compressed_data;
-        delete[] decompressed_data;
         return std::unexpected(
             FileDecompressionError(std::string(path), result));
     }
 
-    delete[] compressed_data;
+    return image;
+}
 
-    BufferStream stream(reinterpret_cast<char*>(decompressed_data),
-                        decompressed_size);
-    stream.seek(36); // skip first part of header
+BoyImage BoyImage::fromMappedFile(MappedFile file, size_t pixels_offset,
+                                  uint32_t width, uint32_t height) {
+    BoyImage image;
+    image.width = width;
+    image.height = height;
+    image.pixels =
+        reinterpret_cast<const uint8_t*>(file.getData() + pixels_offset);
+    image.mapped_file = std::move(file);
 
-    uint32_t pixel_width = stream.read<uint32_t>();
-    uint32_t pixel_height = stream.read<uint32_t>();
-    stream.seek(24); // skip the rest of the header
+    return image;
+}
 
-    char* pixel_data = stream.remainder();
+uint32_t BoyImage::getWidth() const { return this->width; }
 
-    sf::Image image;
-    image.create(pixel_width, pixel_height, (uint8_t*)pixel_data);
+uint32_t BoyImage::getHeight() const { return this->height; }
 
-    delete[] decompressed_data;
+const uint8_t* BoyImage::getPixels() const { return this->pixels; }
 
-    return image;
+size_t BoyImage::getPixelsSize() const {
+    return static_cast<size_t>(this->width) * this->height * 4;
 }
 
-} // namespace gooforge
\ No newline at end of file
+} // namespace gooforge
@@ -24,13 +24,32 @@ namespace gooforge {
 void BufferStream::seek(size_t seek_index, bool absolute) {
     size_t absolute_index = absolute ? seek_index : this->index + seek_index;
 
-    if (absolute_index >= this->buffer_size) {
+    if (absolute_index > this->buffer_size) {
         throw std::out_of_range("BufferStream::seek out of range");
     }
 
     this->index = absolute_index;
 }
 
-char* BufferStream::remainder() { return this->buffer + this->index; }
+std::expected<void, Error> BufferStream::trySkip(size_t size) {
+    if (!this->fits(size)) {
+        return std::unexpected(
+            BufferReadError(this->index, size, this->buffer_size));
+    }
+
+    this->index += size;
+
+    return std::expected<void, Error>{};
+}
+
+const char* BufferStream::remainder() { return this->buffer + this->index; }
+
+size_t BufferStream::remaining() const {
+    return this->buffer_size - this->index;
+}
+
+bool BufferStream::fits(size_t size) const {
+    return size <= this->remaining();
+}
 
 } // namespace gooforge
\ No newline at end of file
@@ -19,6 +19,8 @@
 
 #include "editor.hh"
 
+#include <algorithm>
+#include <chrono>
 #include <format>
 #include <variant>
 
@@ -30,10 +32,26 @@
 #include "spdlog.h"
 
 #include "constants.hh"
+#include "item_catalog.hh"
+#include "level_file.hh"
 #include "resource_manager.hh"
+#include "texture_cache.hh"
+#include "thumbnail_atlas.hh"
 
 namespace gooforge {
 
+namespace {
+
+std::string getErrorMessage(Error error) {
+    BaseError* base_error = std::visit(
+        [](auto& derived_error) -> BaseError* { return &derived_error; },
+        error);
+
+    return base_error->getMessage();
+}
+
+} // namespace
+
 EditorAction::~EditorAction() {
     for (auto action : this->implicit_actions) {
         delete action;
@@ -303,52 +321,30 @@ void Editor::registerPropertiesField<std::string, ItemTemplatePropertyTag>(
     ImGui::Text(label);
     ImGui::TableSetColumnIndex(2);
 
-    // calling this every frame is not ideal
-    // but premature optimization is the root of all evil or whatever that guy
-    // said
-    // ;)
-    auto value_resource =
-        ResourceManager::getInstance()->getResource<ItemResource>(
-            std::format("GOOFORGE_ITEM_RESOURCE_{}", value));
-    if (!value_resource) {
-        return; // todo: actually handle this error
-    }
-    auto value_result = value_resource.value()->get();
-    if (!value_result) {
-        return; // todo: actually handle this error
-    }
-    ItemInfo& item_info = value_result.value()->items[0]; // not safe
+    // the catalog is indexed in the background, so nothing here has to parse
+    // item files
+    ItemCatalog* item_catalog = ItemCatalog::getInstance();
+    const ItemCatalogEntry* value_entry = item_catalog->find(value);
+    std::string value_name = value_entry ? value_entry->name : "?";
 
-    if (ImGui::BeginCombo(
-            std::format("##{}", label).c_str(),
-            std::format("{} ({})", item_info.name, value).c_str())) {
+    if (ImGui::BeginCombo(std::format("##{}", label).c_str(),
+                          std::format("{} ({})", value_name, value).c_str())) {
         static char filter[128] = "";
         ImGui::InputText(std::format("##{}itemfilter", label).c_str(), filter,
                          IM_ARRAYSIZE(filter));
-        ImGui::Separator();
-
-        auto item_resources =
-            ResourceManager::getInstance()->getResources<ItemResource>(filter,
-                                                                       25);
-
-        if (!item_resources) {
-            ImGui::EndCombo();
-            return; // todo: actually handle this error
+        if (item_catalog->isIndexing()) {
+            ImGui::ProgressBar(item_catalog->getProgress(), ImVec2(-1.0f, 0.0f),
+                               "Indexing items...");
         }
 
-        for (auto item_resource : *item_resources) {
-            auto item_result = item_resource->get();
-            if (!item_result) {
-                continue;
-            }
+        ImGui::Separator();
 
-            ItemInfo& item_info = item_result.value()->items[0]; // NOT SAFE
-            bool selected = item_info.uuid == value;
+        for (const ItemCatalogEntry* entry : item_catalog->search(filter, 25)) {
+            bool selected = entry->uuid == value;
             if (ImGui::Selectable(
-                    std::format("{} ({})", item_info.name, item_info.uuid)
-                        .c_str(),
+                    std::format("{} ({})", entry->name, entry->uuid).c_str(),
                     selected)) {
-                value = item_info.uuid;
+                value = entry->uuid;
                 modified = true;
             }
 
@@ -380,8 +376,7 @@ void Editor::registerPropertiesField<std::string, TerrainTemplatePropertyTag>(
     ImGui::TableSetColumnIndex(2);
 
     auto terrains_resource =
-        ResourceManager::getInstance()->getResource<TerrainTemplatesResource>(
-            "GOOFORGE_TERRAIN_TEMPLATES_RESOURCE");
+        ResourceManager::getInstance()->getTerrainTemplates();
     if (!terrains_resource) {
         return; // todo: actually handle this error
     }
@@ -514,7 +509,14 @@ void Editor::registerPropertiesField<LiquidType>(
     }
 }
 
-Editor::~Editor() { delete this->level; }
+Editor::~Editor() {
+    ItemCatalog::getInstance()->stopIndexing();
+
+    // also waits for any save, which holds a pointer to save_progress
+    this->closeJournal(false);
+
+    delete this->level;
+}
 
 void Editor::initialize() {
     this->window.create(sf::VideoMode(1920, 1080), "gooforge");
@@ -525,6 +527,10 @@ void Editor::initialize() {
 
     this->view = sf::View(sf::FloatRect(0, 0, 1920, 1080));
 
+    // textures requested while editing load in the background, opening a
+    // level still prefetches everything it needs up front
+    ResourceManager::getInstance()->setAsyncSpriteLoading(true);
+
     sf::Clock delta_clock;
     while (this->window.isOpen()) {
         this->update(delta_clock);
@@ -557,7 +563,7 @@ void Editor::update(sf::Clock& delta_clock) {
             this->selected_entities[0]->getType() == EntityType::GOO_BALL) {
             this->strand_start_ball =
                 static_cast<GooBall*>(this->selected_entities[0]);
-        } else if (this->strand_start_ball &&
+        } else if (this->strand_start_ball && !this->isLevelLoading() &&
                    this->selected_entities.size() == 2 &&
                    this->selected_entities[0]->getType() ==
                        EntityType::GOO_BALL &&
@@ -645,7 +651,9 @@ void Editor::update(sf::Clock& delta_clock) {
             this->doOpenFile();
         }
 
+        // undoing can set entities up again, which may load their resources
         if (sf::Keyboard::isKeyPressed(sf::Keyboard::Scancode::Z) &&
+            !this->isLevelLoading() &&
             this->undo_clock.getElapsedTime() > this->undo_cooldown) {
             if (sf::Keyboard::isKeyPressed(sf::Keyboard::Scancode::LShift)) {
                 this->redoLastUndo();
@@ -657,8 +665,9 @@ void Editor::update(sf::Clock& delta_clock) {
         }
     }
 
+    // strands still to be loaded may refer to a deleted ball
     if (sf::Keyboard::isKeyPressed(sf::Keyboard::Scancode::Delete) &&
-        !this->selected_entities.empty()) {
+        !this->selected_entities.empty() && !this->isLevelLoading()) {
         this->doEntitiesDeletion(this->selected_entities);
     }
 
@@ -666,11 +675,35 @@ void Editor::update(sf::Clock& delta_clock) {
         this->showSelectWOG2DirectoryDialog();
     }
 
+    // the level is built a chunk per frame so the editor stays responsive
+    if (this->level && this->level->isLoading()) {
+        auto loaded = this->level->loadNext(GOOFORGE_LEVEL_LOAD_CHUNK_SIZE);
+        if (!loaded) {
+            this->errors.push_back(loaded.error());
+        } else if (*loaded) {
+            // the journal needs the level saved as it was loaded to be
+            // written on top of
+            this->journal_rebase_needed = true;
+        }
+    }
+
+    this->updateJournal();
+
     if (!this->errors.empty()) {
-        this->doCloseFile();
+        this->doCloseFile(true);
         this->showErrorDialog();
     }
 
+    this->updateSave();
+
+    // the pool is reading the loaded resources while a level loads, the
+    // watcher holds on to the changes until it's done
+    if (!this->level || !this->level->isLoading()) {
+        ResourceManager::getInstance()->reloadChangedResources();
+    }
+
+    ResourceManager::getInstance()->update();
+
     if (this->level) {
         this->level->update();
     }
@@ -906,22 +939,14 @@ void Editor::doOpenFile() {
     args.filterCount = 1;
     nfdresult_t result = NFD_OpenDialogU8_With(&out_path, &args);
     if (result == NFD_OKAY) {
-        LevelInfo level_info;
-        std::string buffer;
-        auto level_info_error =
-            glz::read_file_json<glz::opts{.error_on_unknown_keys = false}>(
-                level_info, out_path, buffer);
-
-        if (level_info_error) {
-            this->errors.push_back(JSONDeserializeError(
-                out_path, glz::format_error(level_info_error, buffer)));
+        auto level_stream = LevelFile::open(out_path);
+        if (!level_stream) {
+            this->errors.push_back(level_stream.error());
         } else {
             this->level_file_path = out_path;
+            this->level_exported = (*level_stream)->isExported();
             this->level = new Level();
-            auto setup_result = this->level->setup(level_info);
-            if (!setup_result) {
-                this->errors.push_back(setup_result.error());
-            }
+            this->level->beginLoad(*level_stream);
         }
 
         NFD_FreePathU8(out_path);
@@ -929,7 +954,189 @@ void Editor::doOpenFile() {
     NFD_Quit();
 }
 
-void Editor::doCloseFile() {
+// only the copy of the level's info is made here, it's written out on its
+// own thread so editing can carry on while it saves. the thread pool could
+// have the item catalog's indexing queued ahead of it
+void Editor::doSave(EditorSaveType type) {
+    if (!this->level || this->isSaving()) {
+        return;
+    }
+
+    this->save_progress = 0.0f;
+    // a failed save stays shown until it's saved, not just autosaved
+    if (type != EditorSaveType::AUTOSAVE) {
+        this->save_error.clear();
+    }
+
+    this->save_type = type;
+
+    // the journal gets everything up to the copy in case the save doesn't
+    // make it, edits after it are journaled on top of the save
+    if (this->journal.isOpen()) {
+        this->flushJournal();
+    }
+
+    // exports get a clean renumbering, other saves keep the uids as they are
+    LevelInfo info = type == EditorSaveType::EXPORT
+                         ? this->level->getExportInfo()
+                         : this->level->getInfo();
+    this->level->rebaseJournal();
+    this->journal.close();
+    this->journal_rebase_needed = false;
+
+    std::atomic<float>* progress = &this->save_progress;
+    this->save_result = std::async(
+        std::launch::async,
+        [info = std::move(info),
+         path = std::filesystem::path(this->level_file_path), type,
+         progress] {
+            switch (type) {
+                case EditorSaveType::EXPORT:
+                    return LevelFile::exportJSON(info, path, progress);
+                case EditorSaveType::AUTOSAVE:
+                    return LevelFile::autosave(info, path, progress);
+                default:
+                    return LevelFile::save(info, path, progress);
+            }
+        });
+}
+
+bool Editor::isSaving() const { return this->save_result.valid(); }
+
+bool Editor::isLevelLoading() const {
+    return this->level && this->level->isLoading();
+}
+
+void Editor::updateSave() {
+    if (!this->save_result.valid() ||
+        this->save_result.wait_for(std::chrono::seconds(0)) !=
+            std::future_status::ready) {
+        return;
+    }
+
+    // edits since the copy was taken are numbered against the save, so when
+    // it fails they can only be journaled on top of a new autosave
+    auto saved = this->save_result.get();
+    if (!saved) {
+        this->save_error = getErrorMessage(saved.error());
+        this->retryJournal();
+        return;
+    }
+
+    if (this->save_type == EditorSaveType::SAVE) {
+        this->level_exported = false;
+    } else if (this->save_type == EditorSaveType::EXPORT) {
+        this->level_exported = true;
+    }
+
+    std::filesystem::path base_path =
+        this->save_type == EditorSaveType::AUTOSAVE
+            ? LevelFile::getAutosavePath(this->level_file_path)
+            : LevelFile::getBinaryPath(this->level_file_path);
+    auto begun = this->journal.begin(
+        LevelJournal::getPath(this->level_file_path), base_path);
+    if (!begun) {
+        this->save_error = getErrorMessage(begun.error());
+        this->retryJournal();
+        return;
+    }
+
+    this->journal_retry_pending = false;
+
+    // the journal isn't written on top of the autosave anymore
+    if (this->save_type != EditorSaveType::AUTOSAVE) {
+        std::error_code error;
+        std::filesystem::remove(
+            LevelFile::getAutosavePath(this->level_file_path), error);
+    }
+}
+
+// edits are journaled a few times a second, and once the journal has grown
+// big enough it's compacted into a new autosave in the background
+void Editor::updateJournal() {
+    if (!this->level || this->level->isLoading() ||
+        this->journal_clock.getElapsedTime() <
+            sf::milliseconds(GOOFORGE_LEVEL_JOURNAL_FLUSH_INTERVAL_MS)) {
+        return;
+    }
+
+    this->journal_clock.restart();
+
+    // everything the level was loaded with would be journaled otherwise.
+    // edits made in the meantime are only collected by the level until then
+    if (this->journal_rebase_needed) {
+        if (!this->journal_retry_pending ||
+            this->journal_retry_clock.getElapsedTime() >=
+                sf::milliseconds(GOOFORGE_LEVEL_JOURNAL_RETRY_INTERVAL_MS)) {
+            this->doSave(EditorSaveType::AUTOSAVE);
+        }
+
+        return;
+    }
+
+    this->flushJournal();
+
+    size_t compact_size =
+        static_cast<size_t>(GOOFORGE_LEVEL_JOURNAL_COMPACT_SIZE_MB) * 1024 *
+        1024;
+    if (!this->isSaving() && this->journal.getSize() > compact_size) {
+        this->doSave(EditorSaveType::AUTOSAVE);
+    }
+}
+
+// the level is autosaved again for the journal to start over on, once
+// enough time has passed that it isn't hammering a disk that's failing
+void Editor::retryJournal() {
+    this->journal_rebase_needed = true;
+    this->journal_retry_pending = true;
+    this->journal_retry_clock.restart();
+}
+
+void Editor::flushJournal() {
+    this->journal.append(this->level->takeJournalRecords());
+    auto flushed = this->journal.flush();
+    if (!flushed) {
+        // a new autosave covers whatever didn't make it
+        spdlog::error("Failed to write the journal: {}",
+                      getErrorMessage(flushed.error()));
+        this->retryJournal();
+    }
+}
+
+// closing the level without saving leaves nothing to recover, unless it's
+// being closed because of an error
+void Editor::closeJournal(bool keep_journal) {
+    // a save still running would start the journal again once it's done
+    if (this->save_result.valid()) {
+        this->save_result.wait();
+        this->updateSave();
+    }
+
+    if (keep_journal) {
+        // a level that's still loading hasn't been edited yet
+        if (this->level && !this->level->isLoading() &&
+            this->journal.isOpen()) {
+            this->flushJournal();
+        }
+
+        this->journal.release();
+        return;
+    }
+
+    if (this->journal.hasStarted()) {
+        this->journal.discard();
+
+        std::error_code error;
+        std::filesystem::remove(
+            LevelFile::getAutosavePath(this->level_file_path), error);
+    }
+}
+
+void Editor::doCloseFile(bool keep_journal) {
+    this->closeJournal(keep_journal);
+    this->journal_rebase_needed = false;
+    this->journal_retry_pending = false;
+
     delete this->level;
     this->level = nullptr;
     this->selected_entities.clear();
@@ -950,13 +1157,18 @@ void Editor::registerMainMenuBar() {
                 this->doOpenFile();
             }
 
+            // a level that's still loading would be saved half empty
+            ImGui::BeginDisabled((this->level && this->level->isLoading()) ||
+                                 this->isSaving());
+            // saving only writes the binary copy, the game needs an export
             if (ImGui::MenuItem("Save", "Ctrl+S")) {
-                if (this->level) {
-                    auto ec = glz::write_file_json<glz::opts{.prettify = true}>(
-                        this->level->getInfo(), this->level_file_path,
-                        std::string{});
-                }
+                this->doSave(EditorSaveType::SAVE);
+            }
+
+            if (ImGui::MenuItem("Export .wog2")) {
+                this->doSave(EditorSaveType::EXPORT);
             }
+            ImGui::EndDisabled();
 
             ImGui::BeginDisabled(); // todo: make work
             if (ImGui::MenuItem("Save As", "Ctrl+Shift+S")) {
@@ -977,19 +1189,22 @@ void Editor::registerMainMenuBar() {
         }
 
         if (ImGui::BeginMenu("Edit")) {
-            ImGui::BeginDisabled(this->selected_entities.empty());
+            ImGui::BeginDisabled(this->selected_entities.empty() ||
+                                 this->isLevelLoading());
             if (ImGui::MenuItem("Delete", "Del")) {
                 this->doEntitiesDeletion(this->selected_entities);
             }
             ImGui::EndDisabled();
 
-            ImGui::BeginDisabled(this->undo_stack.empty());
+            ImGui::BeginDisabled(this->undo_stack.empty() ||
+                                 this->isLevelLoading());
             if (ImGui::MenuItem("Undo", "Ctrl+Z")) {
                 this->undoLastAction();
             }
             ImGui::EndDisabled();
 
-            ImGui::BeginDisabled(this->redo_stack.empty());
+            ImGui::BeginDisabled(this->redo_stack.empty() ||
+                                 this->isLevelLoading());
             if (ImGui::MenuItem("Redo", "Ctrl+Shift+Z")) {
                 this->redoLastUndo();
             }
@@ -998,7 +1213,7 @@ void Editor::registerMainMenuBar() {
             ImGui::EndMenu();
         }
 
-        if (ImGui::BeginMenu("Add")) {
+        if (ImGui::BeginMenu("Add", !this->isLevelLoading())) {
             Vector2f center =
                 Level::screenToWorld(this->window.getView().getCenter());
 
@@ -1039,6 +1254,19 @@ void Editor::registerMainMenuBar() {
             ImGui::EndMenu();
         }
 
+        if (this->isSaving()) {
+            ImGui::ProgressBar(this->save_progress, ImVec2(160.0f, 0.0f),
+                               this->save_type == EditorSaveType::AUTOSAVE
+                                   ? "Autosaving..."
+                                   : "Saving...");
+        } else if (!this->save_error.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f),
+                               "Save failed: %s", this->save_error.c_str());
+        } else if (this->level && !this->level_exported) {
+            ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f),
+                               "Saved, export to update the .wog2");
+        }
+
         ImGui::EndMainMenuBar();
     }
 }
@@ -1048,13 +1276,7 @@ void Editor::registerErrorDialog() {
                                ImGuiWindowFlags_AlwaysAutoResize)) {
         std::string message = "";
         if (!this->errors.empty()) {
-            Error error_value = this->errors.back();
-            BaseError* base_error = std::visit(
-                [](auto& derived_error) -> BaseError* {
-                    return &derived_error;
-                },
-                error_value);
-            message = base_error->getMessage();
+            message = getErrorMessage(this->errors.back());
         }
 
         ImGui::Text(message.c_str());
@@ -1094,9 +1316,70 @@ void Editor::registerSelectWOG2DirectoryDialog() {
 
         ImGui::Separator();
 
-        if (ImGui::Button("OK")) {
+        ImGui::Checkbox("Cache decoded textures and inventory on disk",
+                        &this->texture_cache_enabled);
+        ImGui::BeginDisabled(!this->texture_cache_enabled);
+        static char cache_path[512] = "gooforge_cache";
+        ImGui::InputText("Cache directory", cache_path,
+                         IM_ARRAYSIZE(cache_path));
+        ImGui::InputInt("Cache size (MB)", &this->texture_cache_size_mb);
+        ImGui::EndDisabled();
+
+        ImGui::InputInt("Texture memory budget (MB)",
+                        &this->texture_budget_mb);
+
+        ImGui::Separator();
+
+        // the resources can't be taken again from somewhere else once
+        // they're in use, and taking them from a directory that isn't there
+        // would leave nothing to switch to
+        ResourceManager* resource_manager = ResourceManager::getInstance();
+        std::filesystem::path selected_path(directory_path);
+        std::error_code error;
+        bool valid_path = std::filesystem::is_directory(selected_path, error);
+        bool other_install =
+            resource_manager->hasInventory() &&
+            selected_path.lexically_normal() !=
+                resource_manager->getBasePath().lexically_normal();
+        if (other_install) {
+            ImGui::TextColored(
+                ImVec4(1.0f, 0.3f, 0.3f, 1.0f),
+                "Resources were already loaded from '%s', restart gooforge "
+                "to use a different install",
+                resource_manager->getBasePath().string().c_str());
+        } else if (directory_path[0] != '\0' && !valid_path) {
+            ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f),
+                               "That directory doesn't exist");
+        }
+
+        ImGui::BeginDisabled(!valid_path || other_install);
+        bool accepted = ImGui::Button("OK");
+        ImGui::EndDisabled();
+
+        if (accepted) {
             this->wog2_path = std::filesystem::path(directory_path);
-            ResourceManager::getInstance()->takeInventory(this->wog2_path);
+            this->cache_path = std::filesystem::path(cache_path);
+            if (this->texture_cache_enabled) {
+                TextureCache::getInstance()->enable(
+                    this->cache_path,
+                    static_cast<uint64_t>(
+                        std::max(this->texture_cache_size_mb, 0)) *
+                        1024 * 1024);
+            } else {
+                TextureCache::getInstance()->disable();
+            }
+            ResourceManager::getInstance()->setInventorySnapshotPath(
+                this->texture_cache_enabled
+                    ? this->cache_path / "inventory.snapshot"
+                    : std::filesystem::path());
+            ResourceManager::getInstance()->setTextureBudget(
+                static_cast<size_t>(std::max(this->texture_budget_mb, 0)) *
+                1024 * 1024);
+            auto taken = resource_manager->takeInventory(this->wog2_path);
+            if (!taken) {
+                this->errors.push_back(taken.error());
+            }
+
             ImGui::CloseCurrentPopup();
         }
 
@@ -1111,6 +1394,11 @@ void Editor::showSelectWOG2DirectoryDialog() {
 void Editor::registerLevelWindow() {
     ImGui::Begin("Level");
 
+    if (this->level && this->level->isLoading()) {
+        ImGui::ProgressBar(this->level->getLoadProgress(), ImVec2(-1.0f, 0.0f),
+                           "Loading level...");
+    }
+
     if (this->level) {
         size_t entity_i = 0;
         for (auto& entity : this->level->entities) {
@@ -1125,7 +1413,8 @@ void Editor::registerLevelWindow() {
             }
 
             ImGui::SameLine();
-            ImGui::Image(sprite, ImVec2(textSize.y, textSize.y));
+            ImGui::Image(ThumbnailAtlas::getInstance()->get(sprite),
+                         ImVec2(textSize.y, textSize.y));
             ImGui::SameLine();
             ImGui::Text("%s", text.c_str());
 
@@ -1147,11 +1436,15 @@ void Editor::registerPropertiesWindow() {
             std::string text = entity->getDisplayName();
             ImVec2 textSize = ImGui::CalcTextSize(text.c_str());
 
-            ImGui::Image(entity->getThumbnail(),
-                         ImVec2(textSize.y * 2.0f, textSize.y * 2.0f));
+            ImGui::Image(
+                ThumbnailAtlas::getInstance()->get(entity->getThumbnail()),
+                ImVec2(textSize.y * 2.0f, textSize.y * 2.0f));
             ImGui::SameLine();
             ImGui::Text(text.c_str());
 
+            // changing a template loads it, which the pool may be doing too
+            ImGui::BeginDisabled(this->isLevelLoading());
+
             if (entity->getType() == EntityType::GOO_BALL) {
                 GooBall* goo_ball = static_cast<GooBall*>(entity);
                 GooBallInfo& info = goo_ball->getInfo();
@@ -1383,6 +1676,8 @@ void Editor::registerPropertiesWindow() {
                     ImGui::EndTable();
                 }
             }
+
+            ImGui::EndDisabled();
         }
     }
 
@@ -1392,6 +1687,75 @@ void Editor::registerPropertiesWindow() {
 void Editor::registerResourcesWindow() {
     ImGui::Begin("Resources");
 
+    if (this->level) {
+        struct ResourceUsage {
+                const BaseResource* resource;
+                size_t user_count;
+                size_t byte_size;
+        };
+
+        // the dependency index also has entities only held by the undo
+        // history, those don't count towards the level
+        std::vector<ResourceUsage> usages;
+        size_t texture_bytes = 0;
+        for (auto& [resource, users] :
+             ResourceManager::getInstance()->getResourceUsage()) {
+            size_t user_count = std::count_if(
+                users.begin(), users.end(), [this](Entity* entity) {
+                    return this->level->entities.contains(entity);
+                });
+            if (user_count == 0) {
+                continue;
+            }
+
+            // atlas sprites are listed under their atlas
+            size_t byte_size = 0;
+            if (auto sprite_resource =
+                    dynamic_cast<const SpriteResource*>(resource)) {
+                if (sprite_resource->isAtlasSprite()) {
+                    continue;
+                }
+
+                if (sprite_resource->isLoaded()) {
+                    byte_size = sprite_resource->getByteSize();
+                }
+            }
+
+            texture_bytes += byte_size;
+            usages.push_back({resource, user_count, byte_size});
+        }
+
+        std::sort(usages.begin(), usages.end(),
+                  [](const ResourceUsage& x, const ResourceUsage& y) {
+                      return x.user_count > y.user_count;
+                  });
+
+        ImGui::Text("%zu resources, %.1f MB of textures", usages.size(),
+                    texture_bytes / (1024.0f * 1024.0f));
+
+        if (ImGui::BeginTable("Resource Usage", 3,
+                              ImGuiTableFlags_RowBg |
+                                  ImGuiTableFlags_Resizable |
+                                  ImGuiTableFlags_ScrollY)) {
+            ImGui::TableSetupColumn("Path");
+            ImGui::TableSetupColumn("Entities");
+            ImGui::TableSetupColumn("Texture (KB)");
+            ImGui::TableHeadersRow();
+
+            for (auto& usage : usages) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", usage.resource->getPath().c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%zu", usage.user_count);
+                ImGui::TableNextColumn();
+                ImGui::Text("%zu", usage.byte_size / 1024);
+            }
+
+            ImGui::EndTable();
+        }
+    }
+
     ImGui::End();
 }
 
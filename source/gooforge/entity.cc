@@ -23,9 +23,14 @@
 
 #include "constants.hh"
 #include "level.hh"
+#include "resource_manager.hh"
 
 namespace gooforge {
 
+Entity::~Entity() {
+    ResourceManager::getInstance()->removeEntityResources(this);
+}
+
 bool Entity::wasClicked(Vector2f point) {
     if (!this->click_bounds) {
         return false;
@@ -66,6 +71,12 @@ bool Entity::wasClicked(Vector2f point) {
     return false;
 }
 
+void Entity::markInfoDirty() {
+    if (this->info_level) {
+        this->info_level->markInfoDirty(this);
+    }
+}
+
 bool Entity::getSelected() { return this->selected; }
 
 void Entity::setSelected(bool selected) { this->selected = selected; }
@@ -110,4 +121,51 @@ void Entity::drawSelection(sf::RenderWindow* window) {
 
 EntityType Entity::getType() const { return this->type; }
 
+// swaps the placeholder for the real sprite once it has been uploaded
+void Entity::updatePendingSprite() {
+    if (this->pending_sprite && this->pending_sprite->isReady()) {
+        this->pending_sprite = nullptr;
+        this->refresh();
+    }
+}
+
+// marks the sprite as used this frame, bringing it back if it was evicted
+void Entity::touchSprite() {
+    if (!this->sprite_resource) {
+        return;
+    }
+
+    this->sprite_resource->touch();
+
+    if (this->sprite_evicted && !this->pending_sprite) {
+        this->sprite_evicted = false;
+        this->sprite_resource->get(); // queues the reload
+        this->pending_sprite = this->sprite_resource;
+    }
+}
+
+void Entity::notifySpriteEvicted() { this->sprite_evicted = true; }
+
+void Entity::setSpriteResource(SpriteResource* sprite_resource) {
+    this->sprite_resource = sprite_resource;
+    this->pending_sprite =
+        sprite_resource->isReady() ? nullptr : sprite_resource;
+    this->sprite_evicted = false;
+}
+
+void Entity::useResources(std::vector<BaseResource*> resources) {
+    // atlas sprites are loaded, evicted and reloaded through their atlas, so
+    // the entity depends on that too
+    if (this->sprite_resource) {
+        SpriteResource* texture_resource =
+            this->sprite_resource->getTextureResource();
+        if (texture_resource && texture_resource != this->sprite_resource) {
+            resources.push_back(texture_resource);
+        }
+    }
+
+    ResourceManager::getInstance()->setEntityResources(this,
+                                                       std::move(resources));
+}
+
 } // namespace gooforge
\ No newline at end of file
@@ -36,6 +36,18 @@ std::string JSONDeserializeError::getMessage() {
            "', with error '" + this->glaze_message + "'";
 }
 
+BEVEDeserializeError::BEVEDeserializeError(std::string file_path,
+                                           std::string glaze_message) {
+    this->file_path = file_path;
+    this->glaze_message = glaze_message;
+    spdlog::error(this->getMessage());
+}
+
+std::string BEVEDeserializeError::getMessage() {
+    return "Failed to deserialize BEVE file '" + this->file_path +
+           "', with error '" + this->glaze_message + "'";
+}
+
 XMLDeserializeError::XMLDeserializeError(std::string file_path,
                                          std::string pugixml_message) {
     this->file_path = file_path;
@@ -98,4 +110,18 @@ std::string LevelSetupError::getMessage() {
     return "Failed to setup GooBall with error '" + this->setup_error + "'";
 }
 
+BufferReadError::BufferReadError(size_t offset, size_t size,
+                                 size_t buffer_size) {
+    this->offset = offset;
+    this->size = size;
+    this->buffer_size = buffer_size;
+    spdlog::error(this->getMessage());
+}
+
+std::string BufferReadError::getMessage() {
+    return "Failed to read " + std::to_string(this->size) +
+           " bytes at offset " + std::to_string(this->offset) +
+           " from a buffer of size " + std::to_string(this->buffer_size);
+}
+
 } // namespace gooforge
\ No newline at end of file
@@ -31,6 +31,35 @@ namespace gooforge {
 
 GooBall::~GooBall() { delete this->click_bounds; }
 
+std::optional<GooBallResources> GooBall::resolve(const GooBallInfo& info) {
+    ResourceManager* resource_manager = ResourceManager::getInstance();
+    auto template_resource = resource_manager->getBallTemplate(info.typeEnum);
+    if (!template_resource) {
+        return std::nullopt;
+    }
+
+    BallTemplateInfo* ball_template = template_resource.value()->getLoaded();
+    if (!ball_template) {
+        return std::nullopt;
+    }
+
+    for (auto& part : ball_template->ballParts) {
+        if (part.name == ball_template->bodyPart.partName) {
+            auto sprite_resource =
+                resource_manager->getResource<SpriteResource>(
+                    GooBall::getBodyPartImageId(info.typeEnum, part));
+            if (!sprite_resource) {
+                return std::nullopt;
+            }
+
+            return GooBallResources{*template_resource, ball_template, &part,
+                                    *sprite_resource};
+        }
+    }
+
+    return std::nullopt;
+}
+
 std::expected<void, Error> GooBall::setup(Level* level, GooBallInfo info,
                                           TerrainGroup* terrain_group) {
     this->level = level;
@@ -39,13 +68,18 @@ std::expected<void, Error> GooBall::setup(Level* level, GooBallInfo info,
     return this->refresh();
 }
 
+std::expected<void, Error> GooBall::setup(Level* level, GooBallInfo info,
+                                          TerrainGroup* terrain_group,
+                                          const GooBallResources& resources) {
+    this->level = level;
+    this->info = std::move(info);
+    this->terrain_group = terrain_group;
+    return this->link(resources);
+}
+
 std::expected<void, Error> GooBall::refresh() {
-    std::string resource_id =
-        "GOOFORGE_BALL_TEMPLATE_RESOURCE_" +
-        std::to_string(static_cast<int>(this->info.typeEnum));
     auto template_resource =
-        ResourceManager::getInstance()->getResource<BallTemplateResource>(
-            resource_id);
+        ResourceManager::getInstance()->getBallTemplate(this->info.typeEnum);
     if (!template_resource) {
         return std::unexpected(template_resource.error());
     }
@@ -57,27 +91,13 @@ std::expected<void, Error> GooBall::refresh() {
 
     this->ball_template = *template_info;
 
-    bool found_body_part = false;
     for (auto& part : this->ball_template->ballParts) {
         if (part.name == this->ball_template->bodyPart.partName) {
-            std::string sprite_resource_id;
-            // hardcoded cases for balls that require flash animations
-            // TODO: implement flash
-            if (part.images.empty()) {
-                if (this->info.typeEnum == GooBallType::THRUSTER) {
-                    sprite_resource_id = "FlashAnim_BallThruster_body";
-                } else if (this->info.typeEnum == GooBallType::LAUNCHER_L2L) {
-                    sprite_resource_id = "FlashAnim_LiquidLauncher_body";
-                } else if (this->info.typeEnum == GooBallType::LAUNCHER_L2B) {
-                    sprite_resource_id = "FlashAnim_BallLauncher_body";
-                } else if (this->info.typeEnum == GooBallType::LIGHTBALL) {
-                    sprite_resource_id = "FlashAnim_Lightball_ball";
-                } else {
-                    return std::unexpected(GooBallSetupError(
-                        this->info.uid, "failed to find body part image"));
-                }
-            } else {
-                sprite_resource_id = part.images[0].imageId.imageId;
+            std::string sprite_resource_id =
+                GooBall::getBodyPartImageId(this->info.typeEnum, part);
+            if (sprite_resource_id.empty()) {
+                return std::unexpected(GooBallSetupError(
+                    this->info.uid, "failed to find body part image"));
             }
 
             auto sprite_resource =
@@ -87,32 +107,63 @@ std::expected<void, Error> GooBall::refresh() {
                 return std::unexpected(sprite_resource.error());
             }
 
-            auto sprite = sprite_resource.value()->get();
-            if (!sprite) {
-                return std::unexpected(sprite.error());
-            }
-
-            this->display_sprite = *sprite;
-
-            if (this->click_bounds) delete this->click_bounds;
-            this->click_bounds =
-                static_cast<EntityClickBoundShape*>(new EntityClickBoundCircle(
-                    0.5 * this->ball_template->width *
-                    (1.0 + this->ball_template->sizeVariance) * part.scale));
-            this->body_part = &part;
-            found_body_part = true;
-            break;
+            return this->link(GooBallResources{
+                *template_resource, this->ball_template, &part,
+                *sprite_resource});
         }
     }
 
-    if (!found_body_part) {
-        return std::unexpected(GooBallSetupError(
-            this->info.uid, "failed to find specified body part"));
+    return std::unexpected(GooBallSetupError(
+        this->info.uid, "failed to find specified body part"));
+}
+
+std::expected<void, Error> GooBall::link(const GooBallResources& resources) {
+    this->ball_template = resources.ball_template;
+
+    auto sprite = resources.sprite_resource->get();
+    if (!sprite) {
+        return std::unexpected(sprite.error());
     }
 
+    this->display_sprite = *sprite;
+    this->setSpriteResource(resources.sprite_resource);
+    this->useResources(
+        {resources.template_resource, resources.sprite_resource});
+
+    if (this->click_bounds) delete this->click_bounds;
+    this->click_bounds =
+        static_cast<EntityClickBoundShape*>(new EntityClickBoundCircle(
+            0.5 * this->ball_template->width *
+            (1.0 + this->ball_template->sizeVariance) *
+            resources.body_part->scale));
+    this->body_part = resources.body_part;
+
     return std::expected<void, Error>{};
 }
 
+// returns an empty string if the part has no usable image
+std::string GooBall::getBodyPartImageId(GooBallType type,
+                                        const BallTemplateBallPartInfo& part) {
+    if (!part.images.empty()) {
+        return part.images[0].imageId.imageId;
+    }
+
+    // hardcoded cases for balls that require flash animations
+    // TODO: implement flash
+    switch (type) {
+        case GooBallType::THRUSTER:
+            return "FlashAnim_BallThruster_body";
+        case GooBallType::LAUNCHER_L2L:
+            return "FlashAnim_LiquidLauncher_body";
+        case GooBallType::LAUNCHER_L2B:
+            return "FlashAnim_BallLauncher_body";
+        case GooBallType::LIGHTBALL:
+            return "FlashAnim_Lightball_ball";
+        default:
+            return "";
+    }
+}
+
 void GooBall::update() {}
 
 // TODO: make this less awful
@@ -151,6 +202,7 @@ float GooBall::getDepth() const {
 
 void GooBall::setPosition(Vector2f position) {
     this->info.pos = position;
+    this->markInfoDirty();
 
     for (auto strand : this->strands) {
         strand->refresh();
@@ -241,6 +293,7 @@ TerrainGroup* GooBall::getTerrainGroup() { return this->terrain_group; }
 
 void GooBall::setTerrainGroup(TerrainGroup* terrain_group) {
     this->terrain_group = terrain_group;
+    this->markInfoDirty();
 
     this->level->updateBall(this);
 
@@ -265,9 +318,13 @@ GooBallType GooBall::getBallType() { return this->info.typeEnum; }
 
 void GooBall::setBallType(GooBallType type) {
     this->info.typeEnum = type;
+    this->markInfoDirty();
     this->refresh();
 }
 
-void GooBall::setRotation(float rotation) { this->info.angle = rotation; }
+void GooBall::setRotation(float rotation) {
+    this->info.angle = rotation;
+    this->markInfoDirty();
+}
 
 } // namespace gooforge
\ No newline at end of file
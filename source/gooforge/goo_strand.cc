@@ -30,6 +30,29 @@ namespace gooforge {
 
 GooStrand::~GooStrand() { delete this->click_bounds; }
 
+std::optional<GooStrandResources> GooStrand::resolve(
+    const GooStrandInfo& info) {
+    ResourceManager* resource_manager = ResourceManager::getInstance();
+    auto template_resource = resource_manager->getBallTemplate(info.type);
+    if (!template_resource) {
+        return std::nullopt;
+    }
+
+    BallTemplateInfo* ball_template = template_resource.value()->getLoaded();
+    if (!ball_template) {
+        return std::nullopt;
+    }
+
+    auto sprite_resource = resource_manager->getResource<SpriteResource>(
+        ball_template->strandImageId.imageId);
+    if (!sprite_resource) {
+        return std::nullopt;
+    }
+
+    return GooStrandResources{*template_resource, ball_template,
+                              *sprite_resource};
+}
+
 std::expected<void, Error> GooStrand::setup(GooStrandInfo info, GooBall* ball1,
                                             GooBall* ball2) {
     this->info = info;
@@ -39,12 +62,19 @@ std::expected<void, Error> GooStrand::setup(GooStrandInfo info, GooBall* ball1,
     return this->refresh();
 }
 
+std::expected<void, Error> GooStrand::setup(
+    GooStrandInfo info, GooBall* ball1, GooBall* ball2,
+    const GooStrandResources& resources) {
+    this->info = std::move(info);
+    this->ball1 = ball1;
+    this->ball2 = ball2;
+
+    return this->link(resources);
+}
+
 std::expected<void, Error> GooStrand::refresh() {
-    std::string resource_id = "GOOFORGE_BALL_TEMPLATE_RESOURCE_" +
-                              std::to_string(static_cast<int>(this->info.type));
     auto template_resource =
-        ResourceManager::getInstance()->getResource<BallTemplateResource>(
-            resource_id);
+        ResourceManager::getInstance()->getBallTemplate(this->info.type);
     if (!template_resource) {
         return std::unexpected(template_resource.error());
     }
@@ -63,12 +93,24 @@ std::expected<void, Error> GooStrand::refresh() {
         return std::unexpected(sprite_resource.error());
     }
 
-    auto sprite = sprite_resource.value()->get();
+    return this->link(GooStrandResources{*template_resource,
+                                         this->ball_template,
+                                         *sprite_resource});
+}
+
+std::expected<void, Error> GooStrand::link(
+    const GooStrandResources& resources) {
+    this->ball_template = resources.ball_template;
+
+    auto sprite = resources.sprite_resource->get();
     if (!sprite) {
         return std::unexpected(sprite.error());
     }
 
     this->display_sprite = *sprite;
+    this->setSpriteResource(resources.sprite_resource);
+    this->useResources(
+        {resources.template_resource, resources.sprite_resource});
 
     if (this->click_bounds) delete this->click_bounds;
     this->click_bounds = static_cast<EntityClickBoundShape*>(
@@ -0,0 +1,326 @@
+// codeshaunted - gooforge
+// source/gooforge/inventory_snapshot.cc
+// contains InventorySnapshot definitions
+// Copyright (C) 2024 codeshaunted
+//
+// This file is part of gooforge.
+// gooforge is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// gooforge is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with gooforge. If not, see <https://www.gnu.org/licenses/>.
+
+#include "inventory_snapshot.hh"
+
+#include <fstream>
+
+#include "buffer_stream.hh"
+
+namespace gooforge {
+
+namespace {
+
+template <typename T>
+void writeValue(std::string& buffer, T value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void writeString(std::string& buffer, std::string_view string) {
+    writeValue<uint32_t>(buffer, static_cast<uint32_t>(string.size()));
+    buffer.append(string);
+}
+
+void writeStamp(std::string& buffer, const InventoryStamp& stamp) {
+    writeString(buffer, stamp.path);
+    writeValue<int64_t>(buffer, stamp.write_time);
+    writeValue<uint64_t>(buffer, stamp.size);
+}
+
+std::expected<std::string_view, Error> readString(BufferStream& stream) {
+    auto size = stream.tryRead<uint32_t>();
+    if (!size) {
+        return std::unexpected(size.error());
+    }
+
+    auto string = stream.tryReadSpan<char>(*size);
+    if (!string) {
+        return std::unexpected(string.error());
+    }
+
+    return std::string_view(string->data(), string->size());
+}
+
+std::expected<InventoryStamp, Error> readStamp(BufferStream& stream) {
+    auto path = readString(stream);
+    if (!path) {
+        return std::unexpected(path.error());
+    }
+
+    auto write_time = stream.tryRead<int64_t>();
+    if (!write_time) {
+        return std::unexpected(write_time.error());
+    }
+
+    auto size = stream.tryRead<uint64_t>();
+    if (!size) {
+        return std::unexpected(size.error());
+    }
+
+    return InventoryStamp{std::string(*path), *write_time, *size};
+}
+
+} // namespace
+
+std::optional<InventoryStamp> InventoryStamp::take(
+    const std::filesystem::path& path) {
+    std::error_code error;
+    auto write_time = std::filesystem::last_write_time(path, error);
+    if (error) {
+        return std::nullopt;
+    }
+
+    InventoryStamp stamp;
+    stamp.path = path.string();
+    stamp.write_time = write_time.time_since_epoch().count();
+
+    // a directory's write time changes whenever something is added to or
+    // removed from it, which is all we need to know about it
+    if (!std::filesystem::is_directory(path, error)) {
+        stamp.size = std::filesystem::file_size(path, error);
+        if (error) {
+            return std::nullopt;
+        }
+    }
+
+    return stamp;
+}
+
+std::optional<InventorySnapshot> InventorySnapshot::load(
+    const std::filesystem::path& path) {
+    std::error_code error;
+    if (!std::filesystem::exists(path, error)) {
+        return std::nullopt;
+    }
+
+    auto file = MappedFile::open(path);
+    if (!file) {
+        return std::nullopt;
+    }
+
+    InventorySnapshot snapshot;
+    snapshot.file = std::move(*file);
+
+    BufferStream stream(snapshot.file.getData(), snapshot.file.getSize());
+    auto magic = stream.tryRead<uint32_t>();
+    auto version = stream.tryRead<uint32_t>();
+    if (!magic || *magic != GOOFORGE_INVENTORY_SNAPSHOT_MAGIC || !version ||
+        *version != GOOFORGE_INVENTORY_SNAPSHOT_VERSION) {
+        return std::nullopt;
+    }
+
+    auto base_path = readString(stream);
+    auto directory_count = stream.tryRead<uint32_t>();
+    auto manifest_count = stream.tryRead<uint32_t>();
+    if (!base_path || !directory_count || !manifest_count) {
+        return std::nullopt;
+    }
+
+    snapshot.base_path = *base_path;
+
+    for (uint32_t i = 0; i < *directory_count; ++i) {
+        auto directory = readStamp(stream);
+        if (!directory) {
+            return std::nullopt;
+        }
+
+        snapshot.directories.push_back(std::move(*directory));
+    }
+
+    // only the stamps are read up front, entries are read for the manifests
+    // that turn out to be unchanged
+    for (uint32_t i = 0; i < *manifest_count; ++i) {
+        auto manifest = readStamp(stream);
+        auto entries_size = stream.tryRead<uint64_t>();
+        if (!manifest || !entries_size) {
+            return std::nullopt;
+        }
+
+        snapshot.entry_offsets.push_back(snapshot.file.getSize() -
+                                         stream.remaining());
+
+        if (!stream.tryReadSpan<char>(*entries_size)) {
+            return std::nullopt;
+        }
+
+        snapshot.manifest_indices.insert({manifest->path, i});
+        snapshot.manifests.push_back(std::move(*manifest));
+    }
+
+    return snapshot;
+}
+
+const std::string& InventorySnapshot::getBasePath() const {
+    return this->base_path;
+}
+
+const std::vector<InventoryStamp>& InventorySnapshot::getDirectories() const {
+    return this->directories;
+}
+
+const std::vector<InventoryStamp>& InventorySnapshot::getManifests() const {
+    return this->manifests;
+}
+
+std::optional<size_t> InventorySnapshot::findManifest(
+    const InventoryStamp& stamp) const {
+    auto it = this->manifest_indices.find(stamp.path);
+    if (it == this->manifest_indices.end() ||
+        this->manifests[it->second] != stamp) {
+        return std::nullopt;
+    }
+
+    return it->second;
+}
+
+std::expected<std::vector<InventoryEntry>, Error>
+InventorySnapshot::getEntries(size_t manifest_index) const {
+    size_t offset = this->entry_offsets[manifest_index];
+    BufferStream stream(this->file.getData() + offset,
+                        this->file.getSize() - offset);
+
+    auto entry_count = stream.tryRead<uint32_t>();
+    if (!entry_count) {
+        return std::unexpected(entry_count.error());
+    }
+
+    std::vector<InventoryEntry> entries;
+    entries.reserve(*entry_count);
+    for (uint32_t i = 0; i < *entry_count; ++i) {
+        InventoryEntry entry;
+
+        auto type = stream.tryRead<uint8_t>();
+        if (!type) {
+            return std::unexpected(type.error());
+        }
+
+        entry.type = static_cast<InventoryEntryType>(*type);
+
+        auto id = readString(stream);
+        if (!id) {
+            return std::unexpected(id.error());
+        }
+
+        entry.id = *id;
+
+        auto path = readString(stream);
+        if (!path) {
+            return std::unexpected(path.error());
+        }
+
+        entry.path = *path;
+
+        if (entry.type == InventoryEntryType::ATLAS_SPRITE) {
+            auto rect = stream.tryRead<sf::IntRect>();
+            if (!rect) {
+                return std::unexpected(rect.error());
+            }
+
+            entry.atlas_rect = *rect;
+        } else if (entry.type == InventoryEntryType::ITEM_CATALOG) {
+            auto name = readString(stream);
+            auto category = readString(stream);
+            auto thumbnail_id = readString(stream);
+            auto item_type = stream.tryRead<uint32_t>();
+            if (!name || !category || !thumbnail_id || !item_type) {
+                return std::unexpected(BufferReadError(
+                    offset, stream.remaining(), this->file.getSize()));
+            }
+
+            entry.name = *name;
+            entry.category = *category;
+            entry.thumbnail_id = *thumbnail_id;
+            entry.item_type = *item_type;
+        }
+
+        entries.push_back(entry);
+    }
+
+    return entries;
+}
+
+void InventorySnapshotWriter::addDirectory(const InventoryStamp& stamp) {
+    writeStamp(this->directories, stamp);
+    ++this->directory_count;
+}
+
+void InventorySnapshotWriter::addManifest(
+    const InventoryStamp& stamp, const std::vector<InventoryEntry>& entries) {
+    std::string buffer;
+    writeValue<uint32_t>(buffer, static_cast<uint32_t>(entries.size()));
+    for (auto& entry : entries) {
+        writeValue<uint8_t>(buffer, static_cast<uint8_t>(entry.type));
+        writeString(buffer, entry.id);
+        writeString(buffer, entry.path);
+        if (entry.type == InventoryEntryType::ATLAS_SPRITE) {
+            writeValue<sf::IntRect>(buffer, entry.atlas_rect);
+        } else if (entry.type == InventoryEntryType::ITEM_CATALOG) {
+            writeString(buffer, entry.name);
+            writeString(buffer, entry.category);
+            writeString(buffer, entry.thumbnail_id);
+            writeValue<uint32_t>(buffer, entry.item_type);
+        }
+    }
+
+    writeStamp(this->manifests, stamp);
+    writeValue<uint64_t>(this->manifests, buffer.size());
+    this->manifests += buffer;
+    ++this->manifest_count;
+}
+
+std::expected<void, Error> InventorySnapshotWriter::write(
+    const std::filesystem::path& path) const {
+    std::filesystem::path temporary_path = path;
+    temporary_path += ".tmp";
+
+    {
+        std::ofstream file(temporary_path, std::ios::binary);
+        if (!file) {
+            return std::unexpected(FileOpenError(temporary_path.string()));
+        }
+
+        std::string header;
+        writeValue<uint32_t>(header, GOOFORGE_INVENTORY_SNAPSHOT_MAGIC);
+        writeValue<uint32_t>(header, GOOFORGE_INVENTORY_SNAPSHOT_VERSION);
+        writeString(header, this->base_path);
+        writeValue<uint32_t>(header, this->directory_count);
+        writeValue<uint32_t>(header, this->manifest_count);
+
+        file.write(header.data(), header.size());
+        file.write(this->directories.data(), this->directories.size());
+        file.write(this->manifests.data(), this->manifests.size());
+        if (!file) {
+            file.close();
+            std::error_code error;
+            std::filesystem::remove(temporary_path, error);
+            return std::unexpected(FileOpenError(temporary_path.string()));
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary_path, path, error);
+    if (error) {
+        std::filesystem::remove(temporary_path, error);
+        return std::unexpected(FileOpenError(path.string()));
+    }
+
+    return std::expected<void, Error>{};
+}
+
+} // namespace gooforge
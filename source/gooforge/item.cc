@@ -30,15 +30,51 @@ namespace gooforge {
 
 ItemInstance::~ItemInstance() { delete this->click_bounds; }
 
+std::optional<ItemInstanceResources> ItemInstance::resolve(
+    const ItemInstanceInfo& info) {
+    ResourceManager* resource_manager = ResourceManager::getInstance();
+    auto item_resource = resource_manager->getItem(info.type);
+    if (!item_resource) {
+        return std::nullopt;
+    }
+
+    ItemInfoFile* info_file = item_resource.value()->getLoaded();
+    if (!info_file || info_file->items.empty()) {
+        return std::nullopt;
+    }
+
+    // same object selection as refresh
+    auto& objects = info_file->items[0].objects;
+    size_t index =
+        info.forcedRandomizationIndex != -1 ? info.forcedRandomizationIndex : 0;
+    if (index >= objects.size()) {
+        return std::nullopt;
+    }
+
+    auto sprite_resource =
+        resource_manager->getResource<SpriteResource>(objects[index].name);
+    if (!sprite_resource) {
+        return std::nullopt;
+    }
+
+    return ItemInstanceResources{*item_resource, info_file, &objects[index],
+                                 *sprite_resource};
+}
+
 std::expected<void, Error> ItemInstance::setup(ItemInstanceInfo info) {
     this->info = info;
     return this->refresh();
 }
 
+std::expected<void, Error> ItemInstance::setup(
+    ItemInstanceInfo info, const ItemInstanceResources& resources) {
+    this->info = std::move(info);
+    return this->link(resources);
+}
+
 std::expected<void, Error> ItemInstance::refresh() {
     auto item_resource =
-        ResourceManager::getInstance()->getResource<ItemResource>(
-            "GOOFORGE_ITEM_RESOURCE_" + this->info.type);
+        ResourceManager::getInstance()->getItem(this->info.type);
     if (!item_resource) {
         return std::unexpected(item_resource.error());
     }
@@ -48,12 +84,27 @@ std::expected<void, Error> ItemInstance::refresh() {
         return std::unexpected(info_file_result.error());
     }
 
-    this->info_file = *info_file_result;
-
     size_t index = this->info.forcedRandomizationIndex != -1
                        ? this->info.forcedRandomizationIndex
                        : 0;
-    this->object_info = &this->info_file->items[0].objects[index];
+    ItemObjectInfo* object_info =
+        &(*info_file_result)->items[0].objects[index];
+
+    auto sprite_resource =
+        ResourceManager::getInstance()->getResource<SpriteResource>(
+            object_info->name);
+    if (!sprite_resource) {
+        return std::unexpected(sprite_resource.error());
+    }
+
+    return this->link(ItemInstanceResources{*item_resource, *info_file_result,
+                                            object_info, *sprite_resource});
+}
+
+std::expected<void, Error> ItemInstance::link(
+    const ItemInstanceResources& resources) {
+    this->info_file = resources.info_file;
+    this->object_info = resources.object_info;
 
     if (this->info.userVariables.size() !=
         this->info_file->items[0].userVariables.size()) {
@@ -65,21 +116,18 @@ std::expected<void, Error> ItemInstance::refresh() {
             this->info.userVariables.push_back(
                 ItemInstanceUserVariableInfo{var.defaultValue});
         }
-    }
 
-    auto sprite_resource =
-        ResourceManager::getInstance()->getResource<SpriteResource>(
-            this->object_info->name);
-    if (!sprite_resource) {
-        return std::unexpected(sprite_resource.error());
+        this->markInfoDirty();
     }
 
-    auto sprite = sprite_resource.value()->get();
+    auto sprite = resources.sprite_resource->get();
     if (!sprite) {
         return std::unexpected(sprite.error());
     }
 
     this->display_sprite = *sprite;
+    this->setSpriteResource(resources.sprite_resource);
+    this->useResources({resources.item_resource, resources.sprite_resource});
 
     sf::Vector2u sprite_size_screen =
         this->display_sprite.getTexture()->getSize();
@@ -171,7 +219,10 @@ float ItemInstance::getRotation() {
 
 float ItemInstance::getDepth() const { return this->info.depth; }
 
-void ItemInstance::setPosition(Vector2f position) { this->info.pos = position; }
+void ItemInstance::setPosition(Vector2f position) {
+    this->info.pos = position;
+    this->markInfoDirty();
+}
 
 ItemInstanceInfo& ItemInstance::getInfo() { return this->info; }
 
@@ -235,20 +286,26 @@ std::string ItemInstance::getItemTemplateUUID() { return this->info.type; }
 
 void ItemInstance::setItemTemplateUUID(std::string uuid) {
     this->info.type = uuid;
+    this->markInfoDirty();
     this->refresh();
 }
 
-void ItemInstance::setDepth(float depth) { this->info.depth = depth; }
+void ItemInstance::setDepth(float depth) {
+    this->info.depth = depth;
+    this->markInfoDirty();
+}
 
 Vector2f ItemInstance::getScale() { return this->info.scale; }
 
 void ItemInstance::setScale(Vector2f scale) {
     this->info.scale = scale;
+    this->markInfoDirty();
     this->refresh();
 }
 
 void ItemInstance::setRotation(float rotation) {
     this->info.rotation = rotation;
+    this->markInfoDirty();
 }
 
 int ItemInstance::getForcedRandomizationIndex() {
@@ -257,6 +314,7 @@ int ItemInstance::getForcedRandomizationIndex() {
 
 void ItemInstance::setForcedRandomizationIndex(int index) {
     this->info.forcedRandomizationIndex = index;
+    this->markInfoDirty();
 }
 
 std::vector<ItemInstanceUserVariableInfo>
@@ -267,6 +325,7 @@ ItemInstance::getUserVariableValues() {
 void ItemInstance::setUserVariableValues(
     std::vector<ItemInstanceUserVariableInfo> values) {
     this->info.userVariables = values;
+    this->markInfoDirty();
 }
 
 } // namespace gooforge
\ No newline at end of file
@@ -0,0 +1,328 @@
+// codeshaunted - gooforge
+// source/gooforge/item_catalog.cc
+// contains ItemCatalog definitions
+// Copyright (C) 2024 codeshaunted
+//
+// This file is part of gooforge.
+// gooforge is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// gooforge is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with gooforge. If not, see <https://www.gnu.org/licenses/>.
+
+#include "item_catalog.hh"
+
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <optional>
+
+#include "glaze/json/read.hpp"
+#include "spdlog.h"
+
+#include "constants.hh"
+#include "inventory_snapshot.hh"
+#include "thread_pool.hh"
+
+namespace gooforge {
+
+namespace {
+
+// just enough of ItemInfoFile to fill in a catalog entry, glaze skips
+// everything else without building it
+struct ItemCatalogObjectInfo {
+        std::string name;
+};
+
+struct ItemCatalogItemInfo {
+        std::string name;
+        std::string uuid;
+        ItemType type;
+        std::string category;
+        std::vector<ItemCatalogObjectInfo> objects;
+};
+
+struct ItemCatalogInfoFile {
+        std::vector<ItemCatalogItemInfo> items;
+};
+
+std::string toLower(std::string_view string) {
+    std::string lower(string);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+
+    return lower;
+}
+
+bool startsWithIgnoreCase(std::string_view string,
+                          std::string_view lower_prefix) {
+    if (string.size() < lower_prefix.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < lower_prefix.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(string[i])) !=
+            lower_prefix[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// the cache is stored as an inventory snapshot with one manifest per item
+// file, holding that item's catalog entry
+ItemCatalogEntry createCatalogEntry(const InventoryEntry& inventory_entry) {
+    return ItemCatalogEntry{std::string(inventory_entry.id),
+                            std::string(inventory_entry.name),
+                            std::string(inventory_entry.category),
+                            static_cast<ItemType>(inventory_entry.item_type),
+                            std::string(inventory_entry.thumbnail_id)};
+}
+
+InventoryEntry createInventoryEntry(const ItemCatalogEntry& entry) {
+    InventoryEntry inventory_entry;
+    inventory_entry.type = InventoryEntryType::ITEM_CATALOG;
+    inventory_entry.id = entry.uuid;
+    inventory_entry.name = entry.name;
+    inventory_entry.category = entry.category;
+    inventory_entry.thumbnail_id = entry.thumbnail_id;
+    inventory_entry.item_type = static_cast<uint32_t>(entry.type);
+
+    return inventory_entry;
+}
+
+} // namespace
+
+std::expected<ItemCatalogEntry, Error> ItemCatalogEntry::loadFromFile(
+    const std::filesystem::path& path) {
+    ItemCatalogInfoFile info_file;
+    std::string buffer;
+    auto error = glz::read_file_json<glz::opts{.error_on_unknown_keys = false}>(
+        info_file, path.string(), buffer);
+    if (error) {
+        return std::unexpected(JSONDeserializeError(
+            path.string(), glz::format_error(error, buffer)));
+    }
+
+    if (info_file.items.empty()) {
+        return std::unexpected(
+            JSONDeserializeError(path.string(), "file has no items"));
+    }
+
+    ItemCatalogItemInfo& item_info = info_file.items[0];
+
+    ItemCatalogEntry entry;
+    entry.uuid = std::move(item_info.uuid);
+    entry.name = std::move(item_info.name);
+    entry.category = std::move(item_info.category);
+    entry.type = item_info.type;
+    if (!item_info.objects.empty()) {
+        entry.thumbnail_id = std::move(item_info.objects[0].name);
+    }
+
+    return entry;
+}
+
+ItemCatalog* ItemCatalog::getInstance() {
+    if (!ItemCatalog::instance) {
+        ItemCatalog::instance = new ItemCatalog();
+    }
+
+    return ItemCatalog::instance;
+}
+
+void ItemCatalog::startIndexing(std::vector<std::filesystem::path> item_paths,
+                                std::filesystem::path cache_path) {
+    this->stopIndexing();
+    this->clear();
+
+    this->indexed_count = 0;
+    this->total_count = item_paths.size();
+    this->indexing = true;
+    this->indexer = std::thread(&ItemCatalog::index, this,
+                                std::move(item_paths), std::move(cache_path));
+}
+
+void ItemCatalog::stopIndexing() {
+    this->stopping = true;
+    if (this->indexer.joinable()) {
+        this->indexer.join();
+    }
+
+    this->stopping = false;
+}
+
+bool ItemCatalog::isIndexing() const { return this->indexing; }
+
+float ItemCatalog::getProgress() const {
+    size_t total_count = this->total_count;
+    if (total_count == 0) {
+        return 1.0f;
+    }
+
+    return static_cast<float>(this->indexed_count) / total_count;
+}
+
+void ItemCatalog::add(ItemCatalogEntry entry) {
+    std::lock_guard lock(this->mutex);
+
+    // the first item with a given uuid wins, same as resource ids
+    if (!this->uuid_indices.insert({entry.uuid, this->entries.size()})
+             .second) {
+        return;
+    }
+
+    this->search_names.push_back(toLower(entry.name));
+    this->entries.push_back(std::move(entry));
+}
+
+void ItemCatalog::clear() {
+    std::lock_guard lock(this->mutex);
+
+    this->entries.clear();
+    this->search_names.clear();
+    this->uuid_indices.clear();
+}
+
+size_t ItemCatalog::getSize() const {
+    std::lock_guard lock(this->mutex);
+
+    return this->entries.size();
+}
+
+const ItemCatalogEntry* ItemCatalog::find(std::string_view uuid) const {
+    std::lock_guard lock(this->mutex);
+
+    auto it = this->uuid_indices.find(uuid);
+    if (it == this->uuid_indices.end()) {
+        return nullptr;
+    }
+
+    return &this->entries[it->second];
+}
+
+std::vector<const ItemCatalogEntry*> ItemCatalog::search(
+    std::string_view filter, size_t limit) const {
+    std::string lower_filter = toLower(filter);
+
+    std::lock_guard lock(this->mutex);
+
+    std::vector<const ItemCatalogEntry*> results;
+    for (size_t i = 0; i < this->entries.size(); ++i) {
+        if (limit > 0 && results.size() >= limit) {
+            break;
+        }
+
+        const ItemCatalogEntry& entry = this->entries[i];
+        if (lower_filter.empty() ||
+            this->search_names[i].find(lower_filter) != std::string::npos ||
+            startsWithIgnoreCase(entry.uuid, lower_filter)) {
+            results.push_back(&entry);
+        }
+    }
+
+    return results;
+}
+
+// runs on the indexer thread
+void ItemCatalog::index(std::vector<std::filesystem::path> item_paths,
+                        std::filesystem::path cache_path) {
+    std::optional<InventorySnapshot> cache;
+    if (!cache_path.empty()) {
+        cache = InventorySnapshot::load(cache_path);
+    }
+
+    struct IndexedItem {
+            std::optional<InventoryStamp> stamp;
+            std::optional<ItemCatalogEntry> entry;
+    };
+
+    // unchanged items come straight out of the cache
+    std::vector<IndexedItem> indexed_items(item_paths.size());
+    std::vector<size_t> uncached_items;
+    for (size_t i = 0; i < item_paths.size(); ++i) {
+        IndexedItem& indexed_item = indexed_items[i];
+        indexed_item.stamp = InventoryStamp::take(item_paths[i]);
+
+        if (cache && indexed_item.stamp) {
+            if (auto index = cache->findManifest(*indexed_item.stamp)) {
+                auto entries = cache->getEntries(*index);
+                if (entries && !entries->empty()) {
+                    indexed_item.entry = createCatalogEntry(entries->front());
+                    this->add(*indexed_item.entry);
+                    ++this->indexed_count;
+                    continue;
+                }
+            }
+        }
+
+        uncached_items.push_back(i);
+    }
+
+    // everything else is parsed on the pool and shows up in searches as soon
+    // as it's parsed. the pool is shared with level loading and texture
+    // decodes, so it only ever gets a few small chunks at a time and
+    // anything submitted in the meantime waits behind those rather than
+    // the whole install
+    ThreadPool* thread_pool = ThreadPool::getInstance();
+    size_t max_chunks = thread_pool->getThreadCount();
+    std::deque<std::future<void>> chunks;
+    for (size_t begin = 0; begin < uncached_items.size() && !this->stopping;
+         begin += GOOFORGE_ITEM_CATALOG_INDEX_CHUNK_SIZE) {
+        if (chunks.size() >= max_chunks) {
+            chunks.front().wait();
+            chunks.pop_front();
+        }
+
+        size_t end = std::min(begin + GOOFORGE_ITEM_CATALOG_INDEX_CHUNK_SIZE,
+                              uncached_items.size());
+        chunks.push_back(thread_pool->submit([this, &item_paths,
+                                              &indexed_items, &uncached_items,
+                                              begin, end] {
+            for (size_t j = begin; j < end && !this->stopping; ++j) {
+                size_t item_index = uncached_items[j];
+                auto entry =
+                    ItemCatalogEntry::loadFromFile(item_paths[item_index]);
+                if (entry) {
+                    this->add(*entry);
+                    indexed_items[item_index].entry = std::move(*entry);
+                }
+
+                ++this->indexed_count;
+            }
+        }));
+    }
+
+    for (auto& chunk : chunks) {
+        chunk.wait();
+    }
+
+    if (!this->stopping && !cache_path.empty() && !uncached_items.empty()) {
+        InventorySnapshotWriter writer("");
+        for (auto& indexed_item : indexed_items) {
+            if (indexed_item.stamp && indexed_item.entry) {
+                writer.addManifest(*indexed_item.stamp,
+                                   {createInventoryEntry(*indexed_item.entry)});
+            }
+        }
+
+        writer.write(cache_path);
+    }
+
+    spdlog::info("Indexed {} items, {} from the cache", this->getSize(),
+                 item_paths.size() - uncached_items.size());
+
+    this->indexing = false;
+}
+
+ItemCatalog* ItemCatalog::instance = nullptr;
+
+} // namespace gooforge
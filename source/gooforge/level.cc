@@ -19,74 +19,417 @@
 
 #include "level.hh"
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <future>
 #include <numbers>
+#include <optional>
 #include <sstream>
+#include <unordered_set>
 
 #include "spdlog.h"
 
 #include "constants.hh"
+#include "level_file.hh"
+#include "level_journal.hh"
+#include "resource_manager.hh"
+#include "thread_pool.hh"
 
 namespace gooforge {
 
+// a chunk of entities on its way into the level. the files they're built
+// from are parsed and then every entity is resolved and its texture decoded
+// on the pool, leaving only the linking for the main thread. only one of the
+// info arrays is filled, chunks never mix entity types
+struct LevelLoadChunk {
+        enum class Stage {
+            PARSE,
+            RESOLVE,
+            DECODE,
+        };
+
+        Stage stage = Stage::PARSE;
+        std::vector<ItemInstanceInfo> items;
+        std::vector<TerrainGroupInfo> terrain_groups;
+        std::vector<GooBallInfo> balls;
+        std::vector<GooStrandInfo> strands;
+        // filled in by the resolve tasks, one slot per info
+        std::vector<std::optional<ItemInstanceResources>> item_resources;
+        std::vector<std::optional<TerrainGroupResources>>
+            terrain_group_resources;
+        std::vector<std::optional<GooBallResources>> ball_resources;
+        std::vector<std::optional<GooStrandResources>> strand_resources;
+        std::vector<std::future<void>> parses;
+        // each hands back the sprites its entities use
+        std::vector<std::future<std::unordered_set<SpriteResource*>>>
+            resolves;
+        SpritePrefetch prefetch;
+        bool isReady() const;
+        void wait() const;
+};
+
+namespace {
+
+template <typename T>
+bool isFutureReady(const std::future<T>& future) {
+    return future.wait_for(std::chrono::seconds(0)) ==
+           std::future_status::ready;
+}
+
+// resolves the infos in a task per thread. the vectors belong to the chunk,
+// which outlives the tasks
+template <typename Info, typename Resources>
+void submitResolves(
+    const std::vector<Info>& infos,
+    std::vector<std::optional<Resources>>& resources,
+    std::vector<std::future<std::unordered_set<SpriteResource*>>>& resolves,
+    std::optional<Resources> (*resolve)(const Info&)) {
+    ThreadPool* thread_pool = ThreadPool::getInstance();
+    resources.resize(infos.size());
+
+    size_t thread_count = std::max<size_t>(1, thread_pool->getThreadCount());
+    size_t slice_size = (infos.size() + thread_count - 1) / thread_count;
+    for (size_t begin = 0; begin < infos.size(); begin += slice_size) {
+        size_t end = std::min(begin + slice_size, infos.size());
+        resolves.push_back(thread_pool->submit(
+            [&infos, &resources, resolve, begin, end] {
+                std::unordered_set<SpriteResource*> sprite_resources;
+                for (size_t i = begin; i < end; ++i) {
+                    resources[i] = resolve(infos[i]);
+                    if (resources[i]) {
+                        sprite_resources.insert(resources[i]->sprite_resource);
+                    }
+                }
+
+                return sprite_resources;
+            }));
+    }
+}
+
+} // namespace
+
+bool LevelLoadChunk::isReady() const {
+    switch (this->stage) {
+        case Stage::PARSE:
+            return std::all_of(this->parses.begin(), this->parses.end(),
+                               isFutureReady<void>);
+        case Stage::RESOLVE:
+            return std::all_of(
+                this->resolves.begin(), this->resolves.end(),
+                isFutureReady<std::unordered_set<SpriteResource*>>);
+        case Stage::DECODE:
+            return this->prefetch.isReady();
+    }
+
+    return true;
+}
+
+// waits for everything submitted so far, the tasks point into the chunk
+void LevelLoadChunk::wait() const {
+    for (auto& parse : this->parses) {
+        parse.wait();
+    }
+
+    for (auto& resolve : this->resolves) {
+        resolve.wait();
+    }
+
+    this->prefetch.wait();
+}
+
 std::expected<void, Error> Level::setup(LevelInfo info) {
-    this->info = info;
+    this->beginLoad(LevelStream::fromInfo(std::move(info)));
+
+    while (true) {
+        auto loaded = this->loadNext(SIZE_MAX);
+        if (!loaded) {
+            return std::unexpected(loaded.error());
+        }
 
-    for (ItemInstanceInfo& item_instance_info : this->info.items) {
+        if (*loaded) {
+            return std::expected<void, Error>{};
+        }
+
+        if (this->load_chunk) {
+            this->load_chunk->wait();
+        }
+    }
+}
+
+void Level::beginLoad(LevelStream* stream) {
+    if (this->load_chunk) {
+        this->load_chunk->wait();
+        delete this->load_chunk;
+        this->load_chunk = nullptr;
+    }
+
+    delete this->stream;
+    this->stream = stream;
+    this->info = std::move(stream->getInfo());
+}
+
+std::expected<bool, Error> Level::loadNext(size_t max_entities) {
+    if (!this->stream) {
+        return true;
+    }
+
+    if (!this->load_chunk) {
+        auto load_chunk = this->takeLoadChunk(max_entities);
+        if (!load_chunk) {
+            return std::unexpected(load_chunk.error());
+        }
+
+        if (!*load_chunk) {
+            delete this->stream;
+            this->stream = nullptr;
+            this->loaded_terrain_groups.clear();
+            this->loaded_balls.clear();
+            this->loaded_ball_count = 0;
+
+            return true;
+        }
+
+        this->load_chunk = *load_chunk;
+    }
+
+    if (!this->advanceLoadChunk()) {
+        return false;
+    }
+
+    auto linked = this->linkLoadChunk();
+    delete this->load_chunk;
+    this->load_chunk = nullptr;
+    if (!linked) {
+        return std::unexpected(linked.error());
+    }
+
+    return false;
+}
+
+bool Level::isLoading() const { return this->stream != nullptr; }
+
+float Level::getLoadProgress() const {
+    if (!this->stream || this->stream->getSize() == 0) {
+        return 1.0f;
+    }
+
+    return static_cast<float>(this->stream->getTakenCount()) /
+           this->stream->getSize();
+}
+
+// entities are taken in the order they can refer to each other, terrain
+// groups before the balls in them and balls before the strands between them.
+// the files they need that aren't loaded yet start parsing right away, each
+// task only touches its own resource. returns nullptr once there's nothing
+// left to take
+std::expected<LevelLoadChunk*, Error> Level::takeLoadChunk(
+    size_t max_entities) {
+    ResourceManager* resource_manager = ResourceManager::getInstance();
+    ThreadPool* thread_pool = ThreadPool::getInstance();
+    LevelLoadChunk* load_chunk = new LevelLoadChunk();
+    // failures are left for the link to hit again and report
+    std::unordered_set<GooBallType> ball_types;
+
+    if (this->stream->getRemaining<ItemInstanceInfo>() > 0) {
+        auto item_instance_infos =
+            this->stream->take<ItemInstanceInfo>(max_entities);
+        if (!item_instance_infos) {
+            delete load_chunk;
+            return std::unexpected(item_instance_infos.error());
+        }
+
+        load_chunk->items = std::move(*item_instance_infos);
+
+        std::unordered_set<ItemResource*> item_resources;
+        for (auto& item_instance_info : load_chunk->items) {
+            auto item_resource =
+                resource_manager->getItem(item_instance_info.type);
+            if (item_resource && !item_resource.value()->isLoaded()) {
+                item_resources.insert(*item_resource);
+            }
+        }
+
+        for (ItemResource* item_resource : item_resources) {
+            load_chunk->parses.push_back(thread_pool->submit(
+                [item_resource] { item_resource->get(); }));
+        }
+    } else if (this->stream->getRemaining<TerrainGroupInfo>() > 0) {
+        auto terrain_group_infos =
+            this->stream->take<TerrainGroupInfo>(max_entities);
+        if (!terrain_group_infos) {
+            delete load_chunk;
+            return std::unexpected(terrain_group_infos.error());
+        }
+
+        load_chunk->terrain_groups = std::move(*terrain_group_infos);
+
+        auto templates_resource = resource_manager->getTerrainTemplates();
+        if (templates_resource && !templates_resource.value()->getLoaded()) {
+            TerrainTemplatesResource* resource = *templates_resource;
+            load_chunk->parses.push_back(
+                thread_pool->submit([resource] { resource->get(); }));
+        }
+    } else if (this->stream->getRemaining<GooBallInfo>() > 0) {
+        auto ball_infos = this->stream->take<GooBallInfo>(max_entities);
+        if (!ball_infos) {
+            delete load_chunk;
+            return std::unexpected(ball_infos.error());
+        }
+
+        load_chunk->balls = std::move(*ball_infos);
+        for (auto& ball_info : load_chunk->balls) {
+            ball_types.insert(ball_info.typeEnum);
+        }
+    } else if (this->stream->getRemaining<GooStrandInfo>() > 0) {
+        auto strand_infos = this->stream->take<GooStrandInfo>(max_entities);
+        if (!strand_infos) {
+            delete load_chunk;
+            return std::unexpected(strand_infos.error());
+        }
+
+        load_chunk->strands = std::move(*strand_infos);
+        for (auto& strand_info : load_chunk->strands) {
+            ball_types.insert(strand_info.type);
+        }
+    } else {
+        delete load_chunk;
+        return nullptr;
+    }
+
+    for (GooBallType ball_type : ball_types) {
+        auto template_resource = resource_manager->getBallTemplate(ball_type);
+        if (template_resource && !template_resource.value()->getLoaded()) {
+            BallTemplateResource* resource = *template_resource;
+            load_chunk->parses.push_back(
+                thread_pool->submit([resource] { resource->get(); }));
+        }
+    }
+
+    return load_chunk;
+}
+
+// moves the chunk along as far as it can go without waiting on the pool,
+// returns true once it's ready to be linked
+bool Level::advanceLoadChunk() {
+    LevelLoadChunk* load_chunk = this->load_chunk;
+
+    if (load_chunk->stage == LevelLoadChunk::Stage::PARSE) {
+        if (!load_chunk->isReady()) {
+            return false;
+        }
+
+        submitResolves(load_chunk->items, load_chunk->item_resources,
+                       load_chunk->resolves, &ItemInstance::resolve);
+        submitResolves(load_chunk->terrain_groups,
+                       load_chunk->terrain_group_resources,
+                       load_chunk->resolves, &TerrainGroup::resolve);
+        submitResolves(load_chunk->balls, load_chunk->ball_resources,
+                       load_chunk->resolves, &GooBall::resolve);
+        submitResolves(load_chunk->strands, load_chunk->strand_resources,
+                       load_chunk->resolves, &GooStrand::resolve);
+        load_chunk->stage = LevelLoadChunk::Stage::RESOLVE;
+    }
+
+    if (load_chunk->stage == LevelLoadChunk::Stage::RESOLVE) {
+        if (!load_chunk->isReady()) {
+            return false;
+        }
+
+        std::unordered_set<SpriteResource*> sprite_resources;
+        for (auto& resolve : load_chunk->resolves) {
+            sprite_resources.merge(resolve.get());
+        }
+
+        load_chunk->resolves.clear();
+        load_chunk->prefetch =
+            ResourceManager::getInstance()->prefetchSprites(
+                std::vector<SpriteResource*>(sprite_resources.begin(),
+                                             sprite_resources.end()));
+        load_chunk->stage = LevelLoadChunk::Stage::DECODE;
+    }
+
+    return load_chunk->isReady();
+}
+
+// adds the chunk's entities, which only has to put together what the pool
+// already found. an entity that couldn't be resolved goes through its
+// regular setup, which reports what's missing
+std::expected<void, Error> Level::linkLoadChunk() {
+    LevelLoadChunk* load_chunk = this->load_chunk;
+    ResourceManager::getInstance()->finishPrefetch(load_chunk->prefetch);
+
+    for (size_t i = 0; i < load_chunk->items.size(); ++i) {
         auto item_instance = new ItemInstance();
-        auto result = item_instance->setup(item_instance_info);
+        auto& resources = load_chunk->item_resources[i];
+        auto result =
+            resources ? item_instance->setup(std::move(load_chunk->items[i]),
+                                             *resources)
+                      : item_instance->setup(std::move(load_chunk->items[i]));
         if (!result) {
             return std::unexpected(result.error());
         }
 
-        this->entities.insert(item_instance);
+        this->insertEntity(item_instance);
     }
 
-    std::vector<TerrainGroup*> terrain_groups_indexed;
-    for (TerrainGroupInfo& terrain_group_info : this->info.terrainGroups) {
+    for (size_t i = 0; i < load_chunk->terrain_groups.size(); ++i) {
         auto terrain_group = new TerrainGroup();
-
-        auto result = terrain_group->setup(terrain_group_info);
+        auto& resources = load_chunk->terrain_group_resources[i];
+        auto result = resources
+                          ? terrain_group->setup(
+                                std::move(load_chunk->terrain_groups[i]),
+                                *resources)
+                          : terrain_group->setup(
+                                std::move(load_chunk->terrain_groups[i]));
         if (!result) {
             return std::unexpected(result.error());
         }
 
-        this->entities.insert(terrain_group);
-        terrain_groups_indexed.push_back(terrain_group);
+        this->insertEntity(terrain_group);
+        this->loaded_terrain_groups.push_back(terrain_group);
     }
 
-    std::vector<GooBall*> goo_balls;
-    std::unordered_map<int, GooBall*> goo_balls_uid;
-    size_t i = 0;
-    for (GooBallInfo& ball_info : this->info.balls) {
+    for (size_t i = 0; i < load_chunk->balls.size(); ++i) {
+        GooBallInfo& ball_info = load_chunk->balls[i];
         auto goo_ball = new GooBall();
-        goo_balls.push_back(goo_ball);
-        goo_balls_uid.insert({ball_info.uid, goo_ball});
-
-        size_t terrain_group_index = this->info.terrainBalls[i].group;
-        auto terrain_group = terrain_group_index == -1
-                                 ? nullptr
-                                 : terrain_groups_indexed[terrain_group_index];
-        auto result = goo_ball->setup(this, ball_info, terrain_group);
+        this->loaded_balls.insert({ball_info.uid, goo_ball});
+
+        size_t terrain_group_index =
+            this->info.terrainBalls[this->loaded_ball_count].group;
+        auto terrain_group =
+            terrain_group_index == -1
+                ? nullptr
+                : this->loaded_terrain_groups[terrain_group_index];
+        auto& resources = load_chunk->ball_resources[i];
+        auto result = resources ? goo_ball->setup(this, std::move(ball_info),
+                                                  terrain_group, *resources)
+                                : goo_ball->setup(this, std::move(ball_info),
+                                                  terrain_group);
         if (!result) {
             return std::unexpected(result.error());
         }
 
-        this->entities.insert(goo_ball);
-        ++i;
+        this->insertEntity(goo_ball);
+        ++this->loaded_ball_count;
     }
 
-    for (GooStrandInfo& strand_info : this->info.strands) {
+    for (size_t i = 0; i < load_chunk->strands.size(); ++i) {
+        GooStrandInfo& strand_info = load_chunk->strands[i];
         auto goo_strand = new GooStrand();
         // ONCE AGAIN NOT SAFE, TODO: FIX
-        auto result =
-            goo_strand->setup(strand_info, goo_balls_uid[strand_info.ball1UID],
-                              goo_balls_uid[strand_info.ball2UID]);
+        GooBall* ball1 = this->loaded_balls[strand_info.ball1UID];
+        GooBall* ball2 = this->loaded_balls[strand_info.ball2UID];
+        auto& resources = load_chunk->strand_resources[i];
+        auto result = resources ? goo_strand->setup(std::move(strand_info),
+                                                    ball1, ball2, *resources)
+                                : goo_strand->setup(std::move(strand_info),
+                                                    ball1, ball2);
         if (!result) {
             return std::unexpected(result.error());
         }
 
-        this->entities.insert(goo_strand);
+        this->insertEntity(goo_strand);
 
         this->addStrand(goo_strand);
     }
@@ -95,45 +438,68 @@ std::expected<void, Error> Level::setup(LevelInfo info) {
 }
 
 LevelInfo& Level::getInfo() {
-    // rebuilds info before returning
+    if (this->entities_dirty) {
+        this->rebuildInfo();
+        return this->info;
+    }
+
+    for (Entity* entity : this->dirty_entities) {
+        this->updateInfo(entity);
+    }
+
+    this->dirty_entities.clear();
+
+    return this->info;
+}
+
+LevelInfo& Level::getExportInfo() {
+    this->rebuildInfo();
+
+    return this->info;
+}
+
+// rebuilds the entity arrays of info from scratch, reassigning every uid
+void Level::rebuildInfo() {
     this->info.items.clear();
     this->info.balls.clear();
     this->info.strands.clear();
     this->info.terrainGroups.clear();
     this->info.terrainBalls.clear();
+    this->info_indices.clear();
+    this->info_entities.clear();
 
-    int terrain_group_i = 0;
-    std::unordered_map<TerrainGroup*, int> terrain_groups;
-    terrain_groups.insert({nullptr, -1});
     int next_uid = 0;
     for (auto entity : this->entities) {
         switch (entity->getType()) {
             case EntityType::GOO_BALL: {
                 GooBall* ball =
                     static_cast<GooBall*>(entity);
-                GooBallInfo& ball_info = ball->getInfo();
-                ball_info.uid = next_uid;
+                ball->info.uid = next_uid;
                 ++next_uid;
 
-                this->info.balls.push_back(ball_info);
+                this->info_indices[ball] = this->info.balls.size();
+                this->info_entities[EntityType::GOO_BALL].push_back(ball);
+                this->info.balls.push_back(ball->info);
                 break;
             }
             case EntityType::ITEM_INSTANCE: {
                 ItemInstance* item =
                     static_cast<ItemInstance*>(entity);
-                ItemInstanceInfo& item_info = item->getInfo();
-                item_info.uid = next_uid;
+                item->getInfo().uid = next_uid;
                 ++next_uid;
 
-                this->info.items.push_back(item_info);
+                this->info_indices[item] = this->info.items.size();
+                this->info_entities[EntityType::ITEM_INSTANCE].push_back(item);
+                this->info.items.push_back(item->getInfo());
                 break;
             }
             case EntityType::TERRAIN_GROUP: {
                 TerrainGroup* terrain_group =
                     static_cast<TerrainGroup*>(entity);
-                terrain_groups.insert({terrain_group, terrain_group_i});
-                ++terrain_group_i;
-
+                this->info_indices[terrain_group] =
+                    this->info.terrainGroups.size();
+                this->info_entities[EntityType::TERRAIN_GROUP].push_back(
+                    terrain_group);
                 this->info.terrainGroups.push_back(terrain_group->getInfo());
             }
         }
@@ -145,38 +511,306 @@ LevelInfo& Level::getInfo() {
 
         auto strand = static_cast<GooStrand*>(entity);
 
-        strand->info.ball1UID = strand->getBall1()->getInfo().uid;
-        strand->info.ball2UID = strand->getBall2()->getInfo().uid;
+        strand->info.ball1UID = strand->getBall1()->info.uid;
+        strand->info.ball2UID = strand->getBall2()->info.uid;
 
+        this->info_indices[strand] = this->info.strands.size();
+        this->info_entities[EntityType::GOO_STRAND].push_back(strand);
         this->info.strands.push_back(strand->info);
     }
 
-    // build terrainBalls
+    // build terrainBalls, in the same order as balls
+    this->info.terrainBalls.resize(this->info.balls.size(),
+                                   TerrainBallInfo(-1));
     for (auto entity : this->entities) {
         if (entity->getType() != EntityType::GOO_BALL) continue;
 
         GooBall* ball = static_cast<GooBall*>(entity);
+        this->info.terrainBalls[this->info_indices[ball]] =
+            TerrainBallInfo(this->getTerrainGroupIndex(ball->terrain_group));
+    }
 
-        int terrain_group_index =
-            terrain_groups[ball->terrain_group]; // not necessarily
-                                                        // safe?
+    this->info_next_uid = next_uid;
+    this->dirty_entities.clear();
+    this->entities_dirty = false;
+}
 
-        this->info.terrainBalls.push_back(TerrainBallInfo(terrain_group_index));
+// copies a changed entity's info over its old copy, keeping the uid it was
+// given when it was added
+void Level::updateInfo(Entity* entity) {
+    auto it = this->info_indices.find(entity);
+    if (it == this->info_indices.end()) {
+        return;
     }
 
-    return this->info;
+    size_t index = it->second;
+    switch (entity->getType()) {
+        case EntityType::GOO_BALL: {
+            GooBall* ball = static_cast<GooBall*>(entity);
+            ball->info.uid = this->info.balls[index].uid;
+            this->info.balls[index] = ball->info;
+            this->info.terrainBalls[index] = TerrainBallInfo(
+                this->getTerrainGroupIndex(ball->terrain_group));
+            break;
+        }
+        case EntityType::ITEM_INSTANCE: {
+            ItemInstance* item = static_cast<ItemInstance*>(entity);
+            item->getInfo().uid = this->info.items[index].uid;
+            this->info.items[index] = item->getInfo();
+            break;
+        }
+        case EntityType::TERRAIN_GROUP: {
+            TerrainGroup* terrain_group = static_cast<TerrainGroup*>(entity);
+            this->info.terrainGroups[index] = terrain_group->getInfo();
+            break;
+        }
+        case EntityType::GOO_STRAND: {
+            GooStrand* strand = static_cast<GooStrand*>(entity);
+            strand->info.ball1UID = strand->getBall1()->info.uid;
+            strand->info.ball2UID = strand->getBall2()->info.uid;
+            this->info.strands[index] = strand->info;
+            break;
+        }
+    }
+}
+
+// gives an added entity a slot at the end of its array, it's filled in by the
+// next getInfo since a strand's balls or a ball's terrain group may not be in
+// info yet
+void Level::appendInfo(Entity* entity) {
+    std::vector<Entity*>& type_entities =
+        this->info_entities[entity->getType()];
+    this->info_indices[entity] = type_entities.size();
+    type_entities.push_back(entity);
+
+    switch (entity->getType()) {
+        case EntityType::GOO_BALL: {
+            GooBall* ball = static_cast<GooBall*>(entity);
+            ball->info.uid = this->info_next_uid;
+            ++this->info_next_uid;
+
+            this->info.balls.push_back(ball->info);
+            this->info.terrainBalls.push_back(TerrainBallInfo(-1));
+            break;
+        }
+        case EntityType::ITEM_INSTANCE: {
+            ItemInstance* item = static_cast<ItemInstance*>(entity);
+            item->getInfo().uid = this->info_next_uid;
+            ++this->info_next_uid;
+
+            this->info.items.push_back(item->getInfo());
+            break;
+        }
+        case EntityType::TERRAIN_GROUP:
+            this->info.terrainGroups.push_back(
+                static_cast<TerrainGroup*>(entity)->getInfo());
+            break;
+        case EntityType::GOO_STRAND:
+            this->info.strands.push_back(static_cast<GooStrand*>(entity)->info);
+            break;
+    }
+
+    this->dirty_entities.insert(entity);
+}
+
+// swaps the last entity of the same type into the removed entity's slot
+void Level::removeInfo(Entity* entity) {
+    auto it = this->info_indices.find(entity);
+    if (it == this->info_indices.end()) {
+        return;
+    }
+
+    size_t index = it->second;
+    this->info_indices.erase(it);
+
+    std::vector<Entity*>& type_entities =
+        this->info_entities[entity->getType()];
+    Entity* moved = type_entities.back();
+    type_entities[index] = moved;
+    type_entities.pop_back();
+    if (moved != entity) {
+        this->info_indices[moved] = index;
+    }
+
+    auto swapAndPop = [index](auto& infos) {
+        infos[index] = std::move(infos.back());
+        infos.pop_back();
+    };
+
+    switch (entity->getType()) {
+        case EntityType::GOO_BALL:
+            swapAndPop(this->info.balls);
+            swapAndPop(this->info.terrainBalls);
+            break;
+        case EntityType::ITEM_INSTANCE:
+            swapAndPop(this->info.items);
+            break;
+        case EntityType::TERRAIN_GROUP:
+            swapAndPop(this->info.terrainGroups);
+
+            // the balls in either group point at a different index now
+            for (Entity* ball_entity :
+                 this->info_entities[EntityType::GOO_BALL]) {
+                GooBall* ball = static_cast<GooBall*>(ball_entity);
+                if (ball->terrain_group == entity ||
+                    ball->terrain_group == moved) {
+                    this->dirty_entities.insert(ball);
+                }
+            }
+            break;
+        case EntityType::GOO_STRAND:
+            swapAndPop(this->info.strands);
+            break;
+    }
+}
+
+// -1 for balls that aren't in a terrain group
+int Level::getTerrainGroupIndex(TerrainGroup* terrain_group) const {
+    auto it = this->info_indices.find(terrain_group);
+    if (!terrain_group || it == this->info_indices.end()) {
+        return -1;
+    }
+
+    return static_cast<int>(it->second);
+}
+
+std::vector<LevelJournalRecord> Level::takeJournalRecords() {
+    std::vector<LevelJournalRecord> records;
+
+    // removals go first, an entity removed and added back since the last
+    // call has to end up added
+    for (auto& [type, index] : this->journal_removals) {
+        LevelJournalRecord record;
+        record.entityType = static_cast<int>(type);
+        record.index = index;
+        record.removed = true;
+        records.push_back(std::move(record));
+    }
+
+    // -1 for entities numbered for an older journal, they can't be in this
+    // one's level
+    auto getJournalIndex = [this](Entity* entity) -> int64_t {
+        if (!entity || entity->journal_generation != this->journal_generation) {
+            return -1;
+        }
+
+        return entity->journal_index;
+    };
+
+    for (Entity* entity : this->journal_entities) {
+        LevelJournalRecord record;
+        record.entityType = static_cast<int>(entity->getType());
+        record.index = entity->journal_index;
+
+        switch (entity->getType()) {
+            case EntityType::GOO_BALL: {
+                GooBall* ball = static_cast<GooBall*>(entity);
+                record.ball = ball->info;
+                record.terrainGroupIndex = getJournalIndex(ball->terrain_group);
+                break;
+            }
+            case EntityType::ITEM_INSTANCE:
+                record.item = static_cast<ItemInstance*>(entity)->getInfo();
+                break;
+            case EntityType::TERRAIN_GROUP:
+                record.terrainGroup =
+                    static_cast<TerrainGroup*>(entity)->getInfo();
+                break;
+            case EntityType::GOO_STRAND: {
+                GooStrand* strand = static_cast<GooStrand*>(entity);
+                record.strand = strand->info;
+                record.ball1Index = getJournalIndex(strand->getBall1());
+                record.ball2Index = getJournalIndex(strand->getBall2());
+                break;
+            }
+        }
+
+        records.push_back(std::move(record));
+    }
+
+    this->journal_removals.clear();
+    this->journal_entities.clear();
+
+    return records;
+}
+
+void Level::rebaseJournal() {
+    ++this->journal_generation;
+
+    for (Entity* entity : this->entities) {
+        entity->journal_index = this->info_indices[entity];
+        entity->journal_generation = this->journal_generation;
+    }
+
+    this->journal_next_indices = {
+        {EntityType::ITEM_INSTANCE, this->info.items.size()},
+        {EntityType::TERRAIN_GROUP, this->info.terrainGroups.size()},
+        {EntityType::GOO_BALL, this->info.balls.size()},
+        {EntityType::GOO_STRAND, this->info.strands.size()}};
+    this->journal_entities.clear();
+    this->journal_removals.clear();
+}
+
+// entities are numbered as they're added, so the ones loaded from a file are
+// numbered the way they are in it
+void Level::insertEntity(Entity* entity) {
+    this->entities.insert(entity);
+    entity->info_level = this;
+    if (!this->entities_dirty) {
+        this->appendInfo(entity);
+    }
+
+    if (entity->journal_generation != this->journal_generation) {
+        entity->journal_index =
+            this->journal_next_indices[entity->getType()]++;
+        entity->journal_generation = this->journal_generation;
+    }
+
+    this->journal_entities.insert(entity);
+}
+
+void Level::eraseEntity(Entity* entity) {
+    this->entities.erase(entity);
+    entity->info_level = nullptr;
+    this->dirty_entities.erase(entity);
+    if (!this->entities_dirty) {
+        this->removeInfo(entity);
+    }
+
+    this->journal_entities.erase(entity);
+    this->journal_removals.push_back(
+        {entity->getType(), entity->journal_index});
+}
+
+void Level::markInfoDirty(Entity* entity) {
+    this->dirty_entities.insert(entity);
+    this->journal_entities.insert(entity);
 }
 
 Level::~Level() {
+    // the chunk's tasks may still be writing into it
+    if (this->load_chunk) {
+        this->load_chunk->wait();
+        delete this->load_chunk;
+    }
+
+    delete this->stream;
+
     for (auto entity : this->entities) {
         delete entity;
     }
 }
 
-void Level::update() {}
+void Level::update() {
+    for (auto entity : this->entities) {
+        entity->updatePendingSprite();
+        entity->update();
+    }
+}
 
 void Level::draw(sf::RenderWindow* window) {
     for (auto entity : this->entities) {
+        entity->touchSprite();
         entity->draw(window);
     }
 
@@ -216,7 +850,7 @@ void Level::removeEntity(Entity* entity) {
             this->removeStrand(static_cast<GooStrand*>(entity));
             break;
         case EntityType::ITEM_INSTANCE:
-            this->entities.erase(entity);
+            this->eraseEntity(entity);
             break;
         default:
             break;
@@ -233,7 +867,7 @@ void Level::addEntity(Entity* entity) {
             break;
         case EntityType::ITEM_INSTANCE:
         case EntityType::TERRAIN_GROUP:
-            this->entities.insert(entity);
+            this->insertEntity(entity);
             break;
         default:
             break;
@@ -245,7 +879,7 @@ void Level::addBall(GooBall* ball) {
         entity->notifyAddBall(ball);
     }
 
-    this->entities.insert(ball);
+    this->insertEntity(ball);
 }
 
 void Level::removeBall(GooBall* ball) {
@@ -253,15 +887,28 @@ void Level::removeBall(GooBall* ball) {
         entity->notifyRemoveBall(ball);
     }
 
-    this->entities.erase(ball);
+    this->eraseEntity(ball);
 }
 
+// only the strand's balls and the terrain group they're in keep track of
+// strands, so there's no need to tell every other entity in the level
 void Level::addStrand(GooStrand* strand) {
-    for (auto entity : this->entities) {
-        entity->notifyAddStrand(strand);
+    GooBall* ball1 = strand->getBall1();
+    GooBall* ball2 = strand->getBall2();
+    if (this->entities.contains(ball1)) {
+        ball1->notifyAddStrand(strand);
+    }
+
+    if (ball2 != ball1 && this->entities.contains(ball2)) {
+        ball2->notifyAddStrand(strand);
+    }
+
+    TerrainGroup* terrain_group = ball1->getTerrainGroup();
+    if (terrain_group && this->entities.contains(terrain_group)) {
+        terrain_group->notifyAddStrand(strand);
     }
 
-    this->entities.insert(strand);
+    this->insertEntity(strand);
 }
 
 void Level::removeStrand(GooStrand* strand) {
@@ -269,7 +916,7 @@ void Level::removeStrand(GooStrand* strand) {
         entity->notifyRemoveStrand(strand);
     }
 
-    this->entities.erase(strand);
+    this->eraseEntity(strand);
 }
 
 void Level::updateBall(GooBall* ball) {
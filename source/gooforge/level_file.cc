@@ -0,0 +1,404 @@
+// codeshaunted - gooforge
+// source/gooforge/level_file.cc
+// contains LevelFile definitions
+// Copyright (C) 2024 codeshaunted
+//
+// This file is part of gooforge.
+// gooforge is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// gooforge is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with gooforge. If not, see <https://www.gnu.org/licenses/>.
+
+#include "level_file.hh"
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "glaze/beve/read.hpp"
+#include "glaze/beve/write.hpp"
+#include "glaze/json/read.hpp"
+#include "glaze/json/write.hpp"
+#include "spdlog.h"
+
+#include "level_journal.hh"
+#include "mapped_file.hh"
+
+namespace gooforge {
+
+namespace {
+
+// the entity arrays are only skipped over here, to find where they are
+struct LevelJSONArrays {
+        glz::raw_json_view items;
+        glz::raw_json_view terrainGroups;
+        glz::raw_json_view balls;
+        glz::raw_json_view strands;
+};
+
+} // namespace
+
+LevelStream* LevelStream::fromInfo(LevelInfo info) {
+    LevelStream* stream = new LevelStream();
+    stream->items.infos = std::move(info.items);
+    stream->terrain_groups.infos = std::move(info.terrainGroups);
+    stream->balls.infos = std::move(info.balls);
+    stream->strands.infos = std::move(info.strands);
+    stream->info = std::move(info);
+
+    return stream;
+}
+
+LevelInfo& LevelStream::getInfo() { return this->info; }
+
+size_t LevelStream::getSize() const {
+    return this->items.getSize() + this->terrain_groups.getSize() +
+           this->balls.getSize() + this->strands.getSize();
+}
+
+size_t LevelStream::getTakenCount() const {
+    return this->items.next + this->terrain_groups.next + this->balls.next +
+           this->strands.next;
+}
+
+bool LevelStream::isExported() const { return this->exported; }
+
+template <typename T>
+std::expected<std::vector<T>, Error> LevelStream::take(size_t max_count) {
+    LevelStreamArray<T>& array = this->getArray<T>();
+    size_t count = std::min(max_count, array.getSize() - array.next);
+
+    std::vector<T> infos;
+    infos.reserve(count);
+    for (size_t i = array.next; i < array.next + count; ++i) {
+        if (!array.infos.empty()) {
+            infos.push_back(std::move(array.infos[i]));
+            continue;
+        }
+
+        T info;
+        auto error = glz::read<glz::opts{.error_on_unknown_keys = false}>(
+            info, array.elements[i]);
+        if (error) {
+            return std::unexpected(JSONDeserializeError(
+                this->path, glz::format_error(error, array.elements[i])));
+        }
+
+        infos.push_back(std::move(info));
+    }
+
+    array.next += count;
+
+    // whatever has been taken isn't needed anymore
+    if (array.next == array.getSize()) {
+        array.infos = std::vector<T>();
+        array.elements = std::vector<std::string_view>();
+    }
+
+    return infos;
+}
+
+template std::expected<std::vector<ItemInstanceInfo>, Error>
+LevelStream::take<ItemInstanceInfo>(size_t max_count);
+template std::expected<std::vector<TerrainGroupInfo>, Error>
+LevelStream::take<TerrainGroupInfo>(size_t max_count);
+template std::expected<std::vector<GooBallInfo>, Error>
+LevelStream::take<GooBallInfo>(size_t max_count);
+template std::expected<std::vector<GooStrandInfo>, Error>
+LevelStream::take<GooStrandInfo>(size_t max_count);
+
+std::expected<LevelStream*, Error> LevelFile::open(
+    const std::filesystem::path& path) {
+    // edits that were never saved are replayed on top of the save they were
+    // journaled against, as long as it hasn't changed since
+    std::filesystem::path journal_path = LevelJournal::getPath(path);
+    auto journal_header = LevelJournal::readHeader(journal_path);
+    if (journal_header) {
+        if (InventoryStamp::take(journal_header->base.path) ==
+            journal_header->base) {
+            auto binary = LevelFile::loadBinary(journal_header->base.path);
+            if (binary) {
+                auto replayed =
+                    LevelJournal::replay(journal_path, binary->level);
+                if (replayed && *replayed) {
+                    spdlog::warn("Recovered unsaved edits to '{}'",
+                                 path.string());
+                    LevelStream* stream =
+                        LevelStream::fromInfo(std::move(binary->level));
+                    stream->exported = false;
+                    return stream;
+                }
+            }
+        } else {
+            spdlog::warn("Ignoring '{}', it was written on top of a save that "
+                         "has changed since",
+                         journal_path.string());
+        }
+    }
+
+    std::filesystem::path binary_path = LevelFile::getBinaryPath(path);
+
+    std::error_code error;
+    if (std::filesystem::exists(binary_path, error)) {
+        // the json may have been replaced with one that has an older write
+        // time, so anything but the exact json the copy was written with
+        // means the copy is stale
+        auto binary = LevelFile::loadBinary(binary_path);
+        if (!binary) {
+            // most likely written by a gooforge with a different LevelInfo
+            spdlog::warn("Falling back to '{}'", path.string());
+        } else if (binary->source == InventoryStamp::take(path)) {
+            LevelStream* stream =
+                LevelStream::fromInfo(std::move(binary->level));
+            stream->exported = binary->exported;
+            return stream;
+        } else {
+            spdlog::warn("Ignoring '{}', '{}' has changed since it was saved",
+                         binary_path.string(), path.string());
+        }
+    }
+
+    return LevelFile::openJSON(path);
+}
+
+std::expected<void, Error> LevelFile::save(const LevelInfo& info,
+                                           const std::filesystem::path& path,
+                                           std::atomic<float>* progress) {
+    auto result = LevelFile::saveBinary(
+        info, path, LevelFile::getBinaryPath(path), false);
+    if (progress) {
+        *progress = 1.0f;
+    }
+
+    return result;
+}
+
+std::expected<void, Error> LevelFile::exportJSON(
+    const LevelInfo& info, const std::filesystem::path& path,
+    std::atomic<float>* progress) {
+    std::string buffer;
+    auto error = glz::write<glz::opts{.prettify = true}>(info, buffer);
+    if (error) {
+        return std::unexpected(FileOpenError(path.string()));
+    }
+
+    if (progress) {
+        *progress = 0.4f;
+    }
+
+    auto result = LevelFile::writeFile(path, buffer);
+    if (!result) {
+        return std::unexpected(result.error());
+    }
+
+    if (progress) {
+        *progress = 0.8f;
+    }
+
+    result = LevelFile::saveBinary(info, path, LevelFile::getBinaryPath(path),
+                                   true);
+    if (progress) {
+        *progress = 1.0f;
+    }
+
+    return result;
+}
+
+std::expected<void, Error> LevelFile::autosave(
+    const LevelInfo& info, const std::filesystem::path& path,
+    std::atomic<float>* progress) {
+    auto result = LevelFile::saveBinary(
+        info, path, LevelFile::getAutosavePath(path), false);
+    if (progress) {
+        *progress = 1.0f;
+    }
+
+    return result;
+}
+
+std::filesystem::path LevelFile::getBinaryPath(
+    const std::filesystem::path& path) {
+    std::filesystem::path binary_path = path;
+    binary_path += GOOFORGE_LEVEL_BINARY_EXTENSION;
+
+    return binary_path;
+}
+
+std::filesystem::path LevelFile::getAutosavePath(
+    const std::filesystem::path& path) {
+    std::filesystem::path autosave_path = path;
+    autosave_path += GOOFORGE_LEVEL_AUTOSAVE_EXTENSION;
+
+    return autosave_path;
+}
+
+std::expected<LevelStream*, Error> LevelFile::openJSON(
+    const std::filesystem::path& path) {
+    auto file = MappedFile::open(path);
+    if (!file) {
+        return std::unexpected(file.error());
+    }
+
+    LevelStream* stream = new LevelStream();
+    stream->path = path.string();
+    // glaze wants a null terminated buffer, which the mapping isn't
+    stream->buffer.assign(file->getData(), file->getSize());
+
+    LevelJSONArrays arrays;
+    auto error = glz::read<glz::opts{.error_on_unknown_keys = false}>(
+        arrays, stream->buffer);
+    if (error) {
+        JSONDeserializeError deserialize_error(
+            path.string(), glz::format_error(error, stream->buffer));
+        delete stream;
+        return std::unexpected(deserialize_error);
+    }
+
+    // everything else is read out of a copy with the arrays left empty
+    std::vector<std::string_view> array_views = {
+        arrays.items.str, arrays.terrainGroups.str, arrays.balls.str,
+        arrays.strands.str};
+    std::sort(array_views.begin(), array_views.end(),
+              [](std::string_view x, std::string_view y) {
+                  return x.data() < y.data();
+              });
+
+    std::string header;
+    const char* position = stream->buffer.data();
+    for (std::string_view array_view : array_views) {
+        if (array_view.empty()) {
+            continue;
+        }
+
+        header.append(position, array_view.data() - position);
+        header += "[]";
+        position = array_view.data() + array_view.size();
+    }
+
+    header.append(position,
+                  stream->buffer.data() + stream->buffer.size() - position);
+
+    error = glz::read<glz::opts{.error_on_unknown_keys = false}>(stream->info,
+                                                                 header);
+    if (error) {
+        delete stream;
+        return std::unexpected(JSONDeserializeError(
+            path.string(), glz::format_error(error, header)));
+    }
+
+    // each element is only skipped over, it's parsed when it's taken
+    std::pair<std::string_view, std::vector<std::string_view>*> splits[] = {
+        {arrays.items.str, &stream->items.elements},
+        {arrays.terrainGroups.str, &stream->terrain_groups.elements},
+        {arrays.balls.str, &stream->balls.elements},
+        {arrays.strands.str, &stream->strands.elements}};
+    for (auto& [array_view, elements] : splits) {
+        if (array_view.empty()) {
+            continue;
+        }
+
+        std::vector<glz::raw_json_view> element_views;
+        error = glz::read<glz::opts{}>(element_views, array_view);
+        if (error) {
+            JSONDeserializeError deserialize_error(
+                path.string(), glz::format_error(error, array_view));
+            delete stream;
+            return std::unexpected(deserialize_error);
+        }
+
+        elements->reserve(element_views.size());
+        for (auto& element_view : element_views) {
+            elements->push_back(element_view.str);
+        }
+    }
+
+    return stream;
+}
+
+std::expected<LevelBinaryInfo, Error> LevelFile::loadBinary(
+    const std::filesystem::path& path) {
+    LevelBinaryInfo binary;
+    std::string buffer;
+    auto error = glz::read_file_beve<glz::opts{.error_on_unknown_keys = false}>(
+        binary, path.string(), buffer);
+    if (error) {
+        return std::unexpected(BEVEDeserializeError(
+            path.string(), glz::format_error(error, buffer)));
+    }
+
+    if (binary.version != GOOFORGE_LEVEL_BINARY_VERSION) {
+        return std::unexpected(
+            BEVEDeserializeError(path.string(), "unsupported version"));
+    }
+
+    return binary;
+}
+
+std::expected<void, Error> LevelFile::saveBinary(
+    const LevelInfo& info, const std::filesystem::path& path,
+    const std::filesystem::path& binary_path, bool exported) {
+    // written as a LevelBinaryInfo, without copying the level into one
+    uint32_t version = GOOFORGE_LEVEL_BINARY_VERSION;
+    std::optional<InventoryStamp> source = InventoryStamp::take(path);
+    std::string buffer;
+    auto error = glz::write_beve(glz::obj{"version", version, "source", source,
+                                          "exported", exported, "level", info},
+                                 buffer);
+    if (error) {
+        return std::unexpected(FileOpenError(binary_path.string()));
+    }
+
+    return LevelFile::writeFile(binary_path, buffer);
+}
+
+std::expected<void, Error> LevelFile::writeFile(
+    const std::filesystem::path& path, std::string_view buffer) {
+    std::filesystem::path temporary_path = path;
+    temporary_path += ".tmp";
+
+    std::FILE* file = std::fopen(temporary_path.string().c_str(), "wb");
+    if (!file) {
+        return std::unexpected(FileOpenError(temporary_path.string()));
+    }
+
+    // everything has to have reached the disk before the old file is
+    // replaced, including the tail that's only written out on close
+    bool written =
+        std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size() &&
+        std::fflush(file) == 0;
+#ifdef _WIN32
+    written = written && _commit(_fileno(file)) == 0;
+#else
+    written = written && fsync(fileno(file)) == 0;
+#endif
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        std::error_code error;
+        std::filesystem::remove(temporary_path, error);
+        return std::unexpected(FileOpenError(temporary_path.string()));
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary_path, path, error);
+    if (error) {
+        std::filesystem::remove(temporary_path, error);
+        return std::unexpected(FileOpenError(path.string()));
+    }
+
+    return std::expected<void, Error>{};
+}
+
+} // namespace gooforge
@@ -0,0 +1,512 @@
+// codeshaunted - gooforge
+// source/gooforge/level_journal.cc
+// contains LevelJournal definitions
+// Copyright (C) 2024 codeshaunted
+//
+// This file is part of gooforge.
+// gooforge is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// gooforge is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with gooforge. If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "level_journal.hh"
+
+#include <array>
+#include <cstring>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "glaze/beve/read.hpp"
+#include "glaze/beve/write.hpp"
+#include "spdlog.h"
+
+#include "mapped_file.hh"
+
+namespace gooforge {
+
+namespace {
+
+std::array<uint32_t, 256> makeCRCTable() {
+    std::array<uint32_t, 256> table;
+    for (uint32_t i = 0; i < table.size(); ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+        }
+
+        table[i] = crc;
+    }
+
+    return table;
+}
+
+uint32_t updateCRC(uint32_t crc, std::string_view data) {
+    static const std::array<uint32_t, 256> table = makeCRCTable();
+
+    for (unsigned char byte : data) {
+        crc = table[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+    }
+
+    return crc;
+}
+
+// covers the size too, so a zero filled tail doesn't pass as empty frames
+uint32_t getFrameCRC(uint32_t frame_size, std::string_view frame) {
+    uint32_t crc = updateCRC(
+        0xFFFFFFFF, std::string_view(reinterpret_cast<const char*>(&frame_size),
+                                     sizeof(frame_size)));
+
+    return updateCRC(crc, frame) ^ 0xFFFFFFFF;
+}
+
+// waits for what's been written to file to reach the disk
+bool syncFile(std::FILE* file) {
+    if (std::fflush(file) != 0) {
+        return false;
+    }
+
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+// splits a journal into its records, stopping at the first one that was cut
+// off or damaged by a crash
+std::vector<std::string_view> readFrames(std::string_view data,
+                                         const std::filesystem::path& path) {
+    std::vector<std::string_view> frames;
+    size_t offset = 0;
+    while (offset < data.size()) {
+        uint32_t frame_size;
+        uint32_t frame_crc;
+        if (data.size() - offset < sizeof(frame_size) + sizeof(frame_crc)) {
+            spdlog::warn("Dropping the cut off end of '{}'", path.string());
+            break;
+        }
+
+        std::memcpy(&frame_size, data.data() + offset, sizeof(frame_size));
+        offset += sizeof(frame_size);
+        std::memcpy(&frame_crc, data.data() + offset, sizeof(frame_crc));
+        offset += sizeof(frame_crc);
+        if (data.size() - offset < frame_size) {
+            spdlog::warn("Dropping the cut off end of '{}'", path.string());
+            break;
+        }
+
+        std::string_view frame = data.substr(offset, frame_size);
+        if (getFrameCRC(frame_size, frame) != frame_crc) {
+            spdlog::warn("Dropping the damaged end of '{}'", path.string());
+            break;
+        }
+
+        frames.push_back(frame);
+        offset += frame_size;
+    }
+
+    return frames;
+}
+
+// max_index is as far as the journal could have numbered entities, anything
+// past it can't have been written by the editor
+template <typename T>
+bool applyRecord(std::vector<std::optional<T>>& slots,
+                 const LevelJournalRecord& record,
+                 const std::optional<T>& value, uint64_t max_index) {
+    if (record.index > max_index) {
+        return false;
+    }
+
+    if (record.index >= slots.size()) {
+        slots.resize(record.index + 1);
+    }
+
+    if (record.removed || !value) {
+        slots[record.index].reset();
+    } else {
+        slots[record.index] = *value;
+    }
+
+    return true;
+}
+
+} // namespace
+
+LevelJournal::~LevelJournal() { this->close(); }
+
+std::filesystem::path LevelJournal::getPath(
+    const std::filesystem::path& level_path) {
+    std::filesystem::path path = level_path;
+    path += GOOFORGE_LEVEL_JOURNAL_EXTENSION;
+
+    return path;
+}
+
+std::expected<void, Error> LevelJournal::begin(
+    const std::filesystem::path& path,
+    const std::filesystem::path& base_path) {
+    if (this->file) {
+        std::fclose(this->file);
+        this->file = nullptr;
+    }
+
+    LevelJournalHeader header;
+    auto base = InventoryStamp::take(base_path);
+    if (!base) {
+        return std::unexpected(FileOpenError(base_path.string()));
+    }
+
+    header.base = *base;
+
+    std::string header_buffer;
+    auto write_error = glz::write_beve(header, header_buffer);
+    if (write_error) {
+        return std::unexpected(FileOpenError(path.string()));
+    }
+
+    std::string buffer;
+    LevelJournal::appendFrame(buffer, header_buffer);
+
+    // the old journal stays until the new one is complete, a crash in
+    // between can still replay it on top of its own base
+    std::filesystem::path temporary_path = path;
+    temporary_path += ".tmp";
+    std::FILE* file = std::fopen(temporary_path.string().c_str(), "wb");
+    if (!file) {
+        return std::unexpected(FileOpenError(temporary_path.string()));
+    }
+
+    if (std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size() ||
+        !syncFile(file)) {
+        std::fclose(file);
+        std::error_code error;
+        std::filesystem::remove(temporary_path, error);
+        return std::unexpected(FileOpenError(temporary_path.string()));
+    }
+
+    std::fclose(file);
+
+    std::error_code error;
+    std::filesystem::rename(temporary_path, path, error);
+    if (error) {
+        std::filesystem::remove(temporary_path, error);
+        return std::unexpected(FileOpenError(path.string()));
+    }
+
+    this->file = std::fopen(path.string().c_str(), "ab");
+    if (!this->file) {
+        return std::unexpected(FileOpenError(path.string()));
+    }
+
+    this->path = path;
+    this->size = buffer.size();
+
+    return this->flush();
+}
+
+void LevelJournal::close() {
+    if (this->file) {
+        std::fclose(this->file);
+        this->file = nullptr;
+    }
+
+    this->pending.clear();
+}
+
+void LevelJournal::discard() {
+    this->close();
+
+    if (!this->path.empty()) {
+        std::error_code error;
+        std::filesystem::remove(this->path, error);
+        this->path.clear();
+    }
+}
+
+void LevelJournal::release() {
+    this->close();
+    this->path.clear();
+}
+
+bool LevelJournal::isOpen() const { return this->file != nullptr; }
+
+bool LevelJournal::hasStarted() const { return !this->path.empty(); }
+
+void LevelJournal::append(const std::vector<LevelJournalRecord>& records) {
+    std::string record_buffer;
+    for (const LevelJournalRecord& record : records) {
+        record_buffer.clear();
+        auto error = glz::write_beve(record, record_buffer);
+        if (error) {
+            spdlog::error("Failed to journal an edit");
+            continue;
+        }
+
+        LevelJournal::appendFrame(this->pending, record_buffer);
+    }
+}
+
+std::expected<void, Error> LevelJournal::flush() {
+    if (!this->file || this->pending.empty()) {
+        return std::expected<void, Error>{};
+    }
+
+    if (std::fwrite(this->pending.data(), 1, this->pending.size(),
+                    this->file) != this->pending.size() ||
+        !syncFile(this->file)) {
+        // a frame written partway would throw off every one after it, so
+        // the journal is cut back to the last flush. it stays closed if
+        // that doesn't work either
+        std::fclose(this->file);
+        this->file = nullptr;
+
+        std::error_code error;
+        std::filesystem::resize_file(this->path, this->size, error);
+        if (!error) {
+            this->file = std::fopen(this->path.string().c_str(), "ab");
+        }
+
+        return std::unexpected(FileOpenError(this->path.string()));
+    }
+
+    this->size += this->pending.size();
+    this->pending.clear();
+
+    return std::expected<void, Error>{};
+}
+
+size_t LevelJournal::getSize() const { return this->size; }
+
+std::optional<LevelJournalHeader> LevelJournal::readHeader(
+    const std::filesystem::path& path) {
+    std::error_code error;
+    if (!std::filesystem::exists(path, error)) {
+        return std::nullopt;
+    }
+
+    auto file = MappedFile::open(path);
+    if (!file) {
+        return std::nullopt;
+    }
+
+    auto frames =
+        readFrames(std::string_view(file->getData(), file->getSize()), path);
+    if (frames.empty()) {
+        return std::nullopt;
+    }
+
+    LevelJournalHeader header;
+    auto read_error = glz::read_beve(header, frames[0]);
+    if (read_error || header.version != GOOFORGE_LEVEL_JOURNAL_VERSION) {
+        return std::nullopt;
+    }
+
+    return header;
+}
+
+std::expected<bool, Error> LevelJournal::replay(
+    const std::filesystem::path& path, LevelInfo& info) {
+    std::error_code error;
+    if (!std::filesystem::exists(path, error)) {
+        return false;
+    }
+
+    auto file = MappedFile::open(path);
+    if (!file) {
+        return std::unexpected(file.error());
+    }
+
+    auto frames =
+        readFrames(std::string_view(file->getData(), file->getSize()), path);
+    if (frames.empty()) {
+        return false;
+    }
+
+    LevelJournalHeader header;
+    auto read_error = glz::read_beve(header, frames[0]);
+    if (read_error || header.version != GOOFORGE_LEVEL_JOURNAL_VERSION) {
+        return false;
+    }
+
+    // the entities as the journal numbers them, removed ones become holes
+    // that are closed up at the end
+    std::vector<std::optional<ItemInstanceInfo>> items(info.items.begin(),
+                                                       info.items.end());
+    std::vector<std::optional<TerrainGroupInfo>> terrain_groups(
+        info.terrainGroups.begin(), info.terrainGroups.end());
+    std::vector<std::optional<GooBallInfo>> balls(info.balls.begin(),
+                                                  info.balls.end());
+    std::vector<std::optional<GooStrandInfo>> strands(info.strands.begin(),
+                                                      info.strands.end());
+
+    std::vector<int64_t> ball_terrain_groups(balls.size(), -1);
+    std::unordered_map<unsigned int, int64_t> ball_indices;
+    for (size_t i = 0; i < info.balls.size(); ++i) {
+        if (i < info.terrainBalls.size()) {
+            ball_terrain_groups[i] = info.terrainBalls[i].group;
+        }
+
+        ball_indices[info.balls[i].uid] = i;
+    }
+
+    std::vector<std::pair<int64_t, int64_t>> strand_balls;
+    for (auto& strand_info : info.strands) {
+        auto ball1 = ball_indices.find(strand_info.ball1UID);
+        auto ball2 = ball_indices.find(strand_info.ball2UID);
+        strand_balls.push_back(
+            {ball1 != ball_indices.end() ? ball1->second : -1,
+             ball2 != ball_indices.end() ? ball2->second : -1});
+    }
+
+    // every entity added since the base was numbered after it, one record
+    // each at least
+    uint64_t added_count = frames.size() - 1;
+
+    size_t record_count = 0;
+    for (size_t i = 1; i < frames.size(); ++i) {
+        LevelJournalRecord record;
+        read_error = glz::read_beve(record, frames[i]);
+        if (read_error) {
+            spdlog::warn("Dropping the unreadable end of '{}'", path.string());
+            break;
+        }
+
+        bool applied = false;
+        switch (static_cast<EntityType>(record.entityType)) {
+            case EntityType::ITEM_INSTANCE:
+                applied = applyRecord(items, record, record.item,
+                                      info.items.size() + added_count);
+                break;
+            case EntityType::TERRAIN_GROUP:
+                applied =
+                    applyRecord(terrain_groups, record, record.terrainGroup,
+                                info.terrainGroups.size() + added_count);
+                break;
+            case EntityType::GOO_BALL:
+                applied = applyRecord(balls, record, record.ball,
+                                      info.balls.size() + added_count);
+                if (applied) {
+                    ball_terrain_groups.resize(balls.size(), -1);
+                    ball_terrain_groups[record.index] =
+                        record.terrainGroupIndex;
+                }
+                break;
+            case EntityType::GOO_STRAND:
+                applied = applyRecord(strands, record, record.strand,
+                                      info.strands.size() + added_count);
+                if (applied) {
+                    strand_balls.resize(strands.size(), {-1, -1});
+                    strand_balls[record.index] = {record.ball1Index,
+                                                  record.ball2Index};
+                }
+                break;
+        }
+
+        if (!applied) {
+            spdlog::warn("Dropping the unreadable end of '{}'", path.string());
+            break;
+        }
+
+        ++record_count;
+    }
+
+    // uids and terrain group indices are handed out again from scratch, the
+    // same way Level::getExportInfo does
+    info.items.clear();
+    info.terrainGroups.clear();
+    info.balls.clear();
+    info.terrainBalls.clear();
+    info.strands.clear();
+
+    int next_uid = 0;
+    for (auto& item : items) {
+        if (item) {
+            item->uid = next_uid;
+            ++next_uid;
+            info.items.push_back(std::move(*item));
+        }
+    }
+
+    std::vector<int> terrain_group_indices(terrain_groups.size(), -1);
+    for (size_t i = 0; i < terrain_groups.size(); ++i) {
+        if (terrain_groups[i]) {
+            terrain_group_indices[i] = info.terrainGroups.size();
+            info.terrainGroups.push_back(std::move(*terrain_groups[i]));
+        }
+    }
+
+    std::vector<int> ball_uids(balls.size(), -1);
+    for (size_t i = 0; i < balls.size(); ++i) {
+        if (!balls[i]) {
+            continue;
+        }
+
+        balls[i]->uid = next_uid;
+        ball_uids[i] = next_uid;
+        ++next_uid;
+        info.balls.push_back(std::move(*balls[i]));
+
+        int64_t terrain_group = ball_terrain_groups[i];
+        info.terrainBalls.push_back(TerrainBallInfo(
+            terrain_group >= 0 &&
+                    terrain_group <
+                        static_cast<int64_t>(terrain_group_indices.size())
+                ? terrain_group_indices[terrain_group]
+                : -1));
+    }
+
+    // a strand whose ball is gone can't be saved, the editor wouldn't have
+    // kept it around either
+    auto getBallUID = [&ball_uids](int64_t index) {
+        return index >= 0 && index < static_cast<int64_t>(ball_uids.size())
+                   ? ball_uids[index]
+                   : -1;
+    };
+
+    for (size_t i = 0; i < strands.size(); ++i) {
+        if (!strands[i]) {
+            continue;
+        }
+
+        int ball1_uid = getBallUID(strand_balls[i].first);
+        int ball2_uid = getBallUID(strand_balls[i].second);
+        if (ball1_uid == -1 || ball2_uid == -1) {
+            continue;
+        }
+
+        strands[i]->ball1UID = ball1_uid;
+        strands[i]->ball2UID = ball2_uid;
+        info.strands.push_back(std::move(*strands[i]));
+    }
+
+    spdlog::info("Replayed {} edits from '{}'", record_count, path.string());
+
+    return true;
+}
+
+void LevelJournal::appendFrame(std::string& buffer, std::string_view frame) {
+    uint32_t frame_size = static_cast<uint32_t>(frame.size());
+    uint32_t frame_crc = getFrameCRC(frame_size, frame);
+    buffer.append(reinterpret_cast<const char*>(&frame_size),
+                  sizeof(frame_size));
+    buffer.append(reinterpret_cast<const char*>(&frame_crc),
+                  sizeof(frame_crc));
+    buffer.append(frame);
+}
+
+} // namespace gooforge
@@ -0,0 +1,146 @@
+// codeshaunted - gooforge
+// source/gooforge/mapped_file.cc
+// contains MappedFile definitions
+// Copyright (C) 2024 codeshaunted
+//
+// This file is part of gooforge.
+// gooforge is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// gooforge is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with gooforge. If not, see <https://www.gnu.org/licenses/>.
+
+#include "mapped_file.hh"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gooforge {
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data(std::exchange(other.data, nullptr)),
+      size(std::exchange(other.size, 0)) {}
+
+MappedFile::~MappedFile() { this->close(); }
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        this->close();
+        this->data = std::exchange(other.data, nullptr);
+        this->size = std::exchange(other.size, 0);
+    }
+
+    return *this;
+}
+
+std::expected<MappedFile, Error> MappedFile::open(
+    const std::filesystem::path& path) {
+    MappedFile file;
+
+#ifdef _WIN32
+    HANDLE file_handle =
+        CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                    OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        return std::unexpected(FileOpenError(path.string()));
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle, &file_size)) {
+        CloseHandle(file_handle);
+        return std::unexpected(FileOpenError(path.string()));
+    }
+
+    // mapping an empty file fails, an empty view is all we need anyway
+    if (file_size.QuadPart == 0) {
+        CloseHandle(file_handle);
+        return file;
+    }
+
+    HANDLE mapping_handle = CreateFileMappingW(file_handle, nullptr,
+                                               PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file_handle);
+    if (!mapping_handle) {
+        return std::unexpected(FileOpenError(path.string()));
+    }
+
+    // the view keeps the mapping alive, so the handle can be closed right away
+    void* view = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping_handle);
+    if (!view) {
+        return std::unexpected(FileOpenError(path.string()));
+    }
+
+    file.data = static_cast<const char*>(view);
+    file.size = static_cast<size_t>(file_size.QuadPart);
+#else
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor == -1) {
+        return std::unexpected(FileOpenError(path.string()));
+    }
+
+    struct stat file_stat;
+    if (fstat(descriptor, &file_stat) == -1) {
+        ::close(descriptor);
+        return std::unexpected(FileOpenError(path.string()));
+    }
+
+    // mapping an empty file fails, an empty view is all we need anyway
+    if (file_stat.st_size == 0) {
+        ::close(descriptor);
+        return file;
+    }
+
+    void* view = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE,
+                      descriptor, 0);
+    ::close(descriptor); // the mapping keeps its own reference to the file
+    if (view == MAP_FAILED) {
+        return std::unexpected(FileOpenError(path.string()));
+    }
+
+    madvise(view, file_stat.st_size, MADV_SEQUENTIAL);
+
+    file.data = static_cast<const char*>(view);
+    file.size = static_cast<size_t>(file_stat.st_size);
+#endif
+
+    return file;
+}
+
+const char* MappedFile::getData() const { return this->data; }
+
+size_t MappedFile::getSize() const { return this->size; }
+
+void MappedFile::close() {
+    if (!this->data) {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(this->data);
+#else
+    munmap(const_cast<char*>(this->data), this->size);
+#endif
+
+    this->data = nullptr;
+    this->size = 0;
+}
+
+} // namespace gooforge
@@ -19,8 +19,12 @@
 
 #include "resource_manager.hh"
 
-#include <fstream>
-#include <regex>
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <future>
+#include <unordered_set>
 
 #include "glaze/json/read.hpp"
 #include "pugixml.hpp"
@@ -28,11 +32,182 @@
 
 #include "boy_image.hh"
 #include "buffer_stream.hh"
+#include "constants.hh"
+#include "mapped_file.hh"
+#include "texture_cache.hh"
+#include "thread_pool.hh"
+#include "thumbnail_atlas.hh"
 
 namespace gooforge {
 
+namespace {
+
+// one sprite inside an .atlas file, these follow the 12 byte header back to
+// back
+struct AtlasRecord {
+        char id[64];
+        uint32_t x_offset;
+        uint32_t y_offset;
+        uint32_t x_size;
+        uint32_t y_size;
+};
+
+static_assert(sizeof(AtlasRecord) == 80);
+
+void addInventoryEntry(const InventoryEntry& entry, ResourceList& resources) {
+    switch (entry.type) {
+        case InventoryEntryType::ATLAS_SPRITE:
+            resources.sprites.push_back(
+                {std::string(entry.id),
+                 SpriteResource(std::string(entry.path), entry.atlas_rect)});
+            break;
+        case InventoryEntryType::ITEM:
+            resources.items.push_back(
+                {std::string(entry.id), ItemResource(std::string(entry.path))});
+            break;
+        case InventoryEntryType::SPRITE:
+            resources.sprites.push_back(
+                {std::string(entry.id), SpriteResource(std::string(entry.path))});
+            break;
+        default:
+            break; // not a resource
+    }
+}
+
+bool isWordCharacter(char character) {
+    return (character >= 'a' && character <= 'z') ||
+           (character >= 'A' && character <= 'Z') ||
+           (character >= '0' && character <= '9') || character == '_';
+}
+
+// they left out quotes on one of the ids for some reason, which messes with
+// pugixml so any unquoted id values get quoted while copying the manifest
+std::string repairManifest(std::string_view xml) {
+    std::string repaired;
+    repaired.reserve(xml.size() + 16);
+
+    size_t index = 0;
+    while (index < xml.size()) {
+        size_t match = xml.find("id=", index);
+        if (match == std::string_view::npos) {
+            repaired.append(xml.substr(index));
+            break;
+        }
+
+        size_t value_begin = match + 3;
+        size_t value_end = value_begin;
+        while (value_end < xml.size() && isWordCharacter(xml[value_end])) {
+            ++value_end;
+        }
+
+        repaired.append(xml.substr(index, value_begin - index));
+        if (value_end > value_begin) {
+            repaired += '"';
+            repaired.append(xml.substr(value_begin, value_end - value_begin));
+            repaired += '"';
+        }
+
+        index = value_end;
+    }
+
+    return repaired;
+}
+
+InventoryEntry createInventoryEntry(const std::string& id,
+                                    const SpriteResource& sprite_resource) {
+    InventoryEntry entry;
+    entry.type = sprite_resource.isAtlasSprite()
+                     ? InventoryEntryType::ATLAS_SPRITE
+                     : InventoryEntryType::SPRITE;
+    entry.id = id;
+    entry.path = sprite_resource.getPath();
+    entry.atlas_rect = sprite_resource.getAtlasRect();
+
+    return entry;
+}
+
+InventoryEntry createInventoryEntry(const std::string& id,
+                                    const ItemResource& item_resource) {
+    InventoryEntry entry;
+    entry.type = InventoryEntryType::ITEM;
+    entry.id = id;
+    entry.path = item_resource.getPath();
+
+    return entry;
+}
+
+// fields of T missing from the file are left alone, and anything in the file
+// that T doesn't have is skipped over without being built
+template <typename T>
+std::expected<T*, Error> readBallTemplate(const std::string& path) {
+    T* template_info = new T();
+    std::string buffer;
+    auto template_info_error =
+        glz::read_file_json<glz::opts{.error_on_unknown_keys = false}>(
+            *template_info, path, buffer);
+
+    if (template_info_error) {
+        delete template_info;
+        return std::unexpected(JSONDeserializeError(
+            path, glz::format_error(template_info_error, buffer)));
+    }
+
+    return template_info;
+}
+
+// for decodes on the pool, anything thrown is turned into an error so it's
+// reported like any other failed decode
+std::expected<BoyImage, Error> decodeOnPool(SpriteResource* sprite_resource) {
+    try {
+        return sprite_resource->decode();
+    } catch (const std::exception& exception) {
+        spdlog::error("Failed to decode '{}': {}", sprite_resource->getPath(),
+                      exception.what());
+        return std::unexpected(FileOpenError(sprite_resource->getPath()));
+    }
+}
+
+} // namespace
+
+std::optional<ItemKey> ItemKey::fromUUID(std::string_view uuid) {
+    ItemKey key;
+    size_t digits = 0;
+    for (char character : uuid) {
+        if (character == '-') {
+            continue;
+        }
+
+        uint64_t value;
+        if (character >= '0' && character <= '9') {
+            value = character - '0';
+        } else if (character >= 'a' && character <= 'f') {
+            value = character - 'a' + 10;
+        } else if (character >= 'A' && character <= 'F') {
+            value = character - 'A' + 10;
+        } else {
+            return std::nullopt;
+        }
+
+        if (digits >= 32) {
+            return std::nullopt;
+        }
+
+        uint64_t& half = digits < 16 ? key.high : key.low;
+        half = (half << 4) | value;
+        ++digits;
+    }
+
+    if (digits != 32) {
+        return std::nullopt;
+    }
+
+    return key;
+}
+
 BaseResource::~BaseResource() { this->unload(); }
 
+const std::string& BaseResource::getPath() const { return this->path; }
+
 std::expected<sf::Sprite, Error> SpriteResource::get() {
     if (this->atlas_sprite) {
         auto atlas_sprite_resource =
@@ -42,55 +217,257 @@ std::expected<sf::Sprite, Error> SpriteResource::get() {
             return std::unexpected(atlas_sprite_resource.error());
         }
 
-        const sf::Texture* atlas_texture =
-            atlas_sprite_resource.value()->get()->getTexture();
+        auto atlas_sprite = atlas_sprite_resource.value()->get();
+        if (!atlas_sprite) {
+            return std::unexpected(atlas_sprite.error());
+        }
+
+        // the atlas is still loading, so our rect would be meaningless on the
+        // placeholder it handed back
+        if (!atlas_sprite_resource.value()->isLoaded()) {
+            return atlas_sprite;
+        }
 
-        return sf::Sprite(*atlas_texture, this->atlas_rect);
+        return sf::Sprite(*atlas_sprite->getTexture(), this->atlas_rect);
     }
 
-    if (this->texture) {
+    if (this->loaded) {
+        this->touch();
         return sf::Sprite(*this->texture);
-    } else {
-        this->texture = new sf::Texture();
-        auto image = BoyImage::loadFromFile(this->path);
-        if (!image) {
-            return std::unexpected(image.error());
+    }
+
+    if (this->decode_error) {
+        return std::unexpected(*this->decode_error);
+    }
+
+    ResourceManager* resource_manager = ResourceManager::getInstance();
+    if (resource_manager->getAsyncSpriteLoading()) {
+        if (!this->loading) {
+            this->loading = true;
+            resource_manager->queueDecode(this);
         }
 
-        this->texture->loadFromImage(*image);
+        return sf::Sprite(*resource_manager->getPlaceholderTexture());
+    }
 
-        return this->get();
+    auto image = this->decode();
+    if (!image) {
+        return std::unexpected(image.error());
     }
+
+    this->upload(*image);
+
+    return this->get();
 }
 
 void SpriteResource::unload() {
+    if (this->loaded) {
+        ResourceManager::getInstance()->untrackTexture(this);
+    }
+
     delete this->texture;
     this->texture = nullptr;
+    this->loaded = false;
+    this->loading = false;
+    this->decode_error.reset();
+}
+
+// frees the texture's memory but keeps the texture object itself, since
+// sprites handed out earlier still point at it, get() loads it back
+void SpriteResource::evict() {
+    if (!this->loaded) {
+        return;
+    }
+
+    ResourceManager::getInstance()->untrackTexture(this);
+
+    *this->texture = sf::Texture();
+    this->loaded = false;
+}
+
+void SpriteResource::touch() {
+    SpriteResource* texture_resource = this->getTextureResource();
+    if (texture_resource) {
+        texture_resource->last_used_frame =
+            ResourceManager::getInstance()->getFrame();
+    }
+}
+
+size_t SpriteResource::getByteSize() const { return this->byte_size; }
+
+uint64_t SpriteResource::getLastUsedFrame() const {
+    return this->last_used_frame;
+}
+
+SpriteResource* SpriteResource::getTextureResource() {
+    if (!this->atlas_sprite) {
+        return this;
+    }
+
+    auto atlas_sprite_resource =
+        ResourceManager::getInstance()->getResource<SpriteResource>(this->path);
+    if (!atlas_sprite_resource) {
+        return nullptr;
+    }
+
+    return *atlas_sprite_resource;
+}
+
+bool SpriteResource::isLoaded() const { return this->loaded; }
+
+// decodes the file again into the same texture object, so sprites handed out
+// earlier show the new pixels
+std::expected<void, Error> SpriteResource::reload() {
+    if (this->atlas_sprite || !this->loaded) {
+        return std::expected<void, Error>{};
+    }
+
+    auto image = this->decode();
+    if (!image) {
+        return std::unexpected(image.error());
+    }
+
+    // thumbnails are keyed on the texture, which is about to change under them
+    ThumbnailAtlas::getInstance()->invalidate(this->texture);
+    this->upload(*image);
+
+    return std::expected<void, Error>{};
+}
+
+bool SpriteResource::isAtlasSprite() const { return this->atlas_sprite; }
+
+sf::IntRect SpriteResource::getAtlasRect() const { return this->atlas_rect; }
+
+const sf::Texture* SpriteResource::getTexture() const { return this->texture; }
+
+bool SpriteResource::isReady() {
+    SpriteResource* texture_resource = this->getTextureResource();
+
+    return texture_resource && texture_resource->isLoaded();
+}
+
+// safe to call from any thread, it doesn't touch the resource's state
+std::expected<BoyImage, Error> SpriteResource::decode() const {
+    TextureCache* texture_cache = TextureCache::getInstance();
+    if (texture_cache->isEnabled()) {
+        auto cached_image = texture_cache->load(this->path);
+        if (cached_image) {
+            return std::move(*cached_image);
+        }
+    }
+
+    auto image = BoyImage::loadFromFile(this->path);
+    if (image && texture_cache->isEnabled()) {
+        texture_cache->store(this->path, *image);
+    }
+
+    return image;
+}
+
+// must be called from the main thread, since it talks to OpenGL
+void SpriteResource::upload(const BoyImage& image) {
+    // the texture object is kept around when reuploading, since sprites
+    // handed out earlier still point at it
+    if (!this->texture) {
+        this->texture = new sf::Texture();
+    }
+
+    // upload straight from the decoded pixels, going through sf::Image
+    // would cost another full copy of the image
+    this->texture->create(image.getWidth(), image.getHeight());
+    this->texture->update(image.getPixels());
+    this->loading = false;
+    this->decode_error.reset();
+
+    if (this->loaded) {
+        ResourceManager::getInstance()->untrackTexture(this);
+    }
+
+    this->loaded = true;
+    this->byte_size = image.getPixelsSize();
+    this->touch();
+    ResourceManager::getInstance()->trackTexture(this);
+}
+
+void SpriteResource::fail(Error error) {
+    this->loading = false;
+    this->decode_error = std::move(error);
 }
 
 std::expected<BallTemplateInfo*, Error> BallTemplateResource::get() {
     if (!this->info) {
-        BallTemplateInfo* template_info = new BallTemplateInfo();
-        std::string buffer;
-        auto template_info_error =
-            glz::read_file_json<glz::opts{.error_on_unknown_keys = false}>(
-                template_info, this->path, buffer);
-
-        if (template_info_error) {
-            delete template_info;
-            return std::unexpected(JSONDeserializeError(
-                this->path, glz::format_error(template_info_error, buffer)));
-        } else {
-            this->info = template_info;
+        auto template_info = readBallTemplate<BallTemplateInfo>(this->path);
+        if (!template_info) {
+            return std::unexpected(template_info.error());
         }
+
+        this->info = *template_info;
     }
 
     return this->info;
 }
 
+BallTemplateInfo* BallTemplateResource::getLoaded() const { return this->info; }
+
+std::expected<FullBallTemplateInfo*, Error> BallTemplateResource::getFull() {
+    if (!this->full_info) {
+        auto template_info = readBallTemplate<FullBallTemplateInfo>(this->path);
+        if (!template_info) {
+            return std::unexpected(template_info.error());
+        }
+
+        this->full_info = *template_info;
+    }
+
+    return this->full_info;
+}
+
 void BallTemplateResource::unload() {
     delete this->info;
     this->info = nullptr;
+    delete this->full_info;
+    this->full_info = nullptr;
+
+    for (BallTemplateInfo* previous_info : this->previous_infos) {
+        delete previous_info;
+    }
+
+    for (FullBallTemplateInfo* previous_full_info :
+         this->previous_full_infos) {
+        delete previous_full_info;
+    }
+
+    this->previous_infos.clear();
+    this->previous_full_infos.clear();
+}
+
+bool BallTemplateResource::isLoaded() const {
+    return this->info != nullptr || this->full_info != nullptr;
+}
+
+std::expected<void, Error> BallTemplateResource::reload() {
+    // the full template is parsed again when it's next asked for
+    if (this->full_info) {
+        this->previous_full_infos.push_back(this->full_info);
+        this->full_info = nullptr;
+    }
+
+    if (!this->info) {
+        return std::expected<void, Error>{};
+    }
+
+    BallTemplateInfo* previous_info = this->info;
+    this->info = nullptr;
+
+    auto template_info = this->get();
+    if (!template_info) {
+        this->info = previous_info;
+        return std::unexpected(template_info.error());
+    }
+
+    this->previous_infos.push_back(previous_info);
+
+    return std::expected<void, Error>{};
 }
 
 std::expected<TerrainTemplateInfoFile*, Error> TerrainTemplatesResource::get() {
@@ -115,6 +492,10 @@ std::expected<TerrainTemplateInfoFile*, Error> TerrainTemplatesResource::get() {
     return this->info_file;
 }
 
+TerrainTemplateInfoFile* TerrainTemplatesResource::getLoaded() const {
+    return this->info_file;
+}
+
 void TerrainTemplatesResource::unload() {
     delete this->info_file;
     this->info_file = nullptr;
@@ -143,6 +524,35 @@ std::expected<ItemInfoFile*, Error> ItemResource::get() {
 void ItemResource::unload() {
     delete this->info_file;
     this->info_file = nullptr;
+
+    for (ItemInfoFile* previous_info_file : this->previous_info_files) {
+        delete previous_info_file;
+    }
+
+    this->previous_info_files.clear();
+}
+
+ItemInfoFile* ItemResource::getLoaded() const { return this->info_file; }
+
+bool ItemResource::isLoaded() const { return this->info_file != nullptr; }
+
+std::expected<void, Error> ItemResource::reload() {
+    if (!this->info_file) {
+        return std::expected<void, Error>{};
+    }
+
+    ItemInfoFile* previous_info_file = this->info_file;
+    this->info_file = nullptr;
+
+    auto item_info_file = this->get();
+    if (!item_info_file) {
+        this->info_file = previous_info_file;
+        return std::unexpected(item_info_file.error());
+    }
+
+    this->previous_info_files.push_back(previous_info_file);
+
+    return std::expected<void, Error>{};
 }
 
 ResourceManager* ResourceManager::getInstance() {
@@ -156,29 +566,214 @@ ResourceManager* ResourceManager::getInstance() {
 
 std::expected<void, Error> ResourceManager::takeInventory(
     std::filesystem::path& base_path) {
+    // resources are handed out as pointers into the pools, so once they're
+    // filled they can't grow again
+    if (this->hasInventory()) {
+        if (base_path.lexically_normal() !=
+            this->base_path.lexically_normal()) {
+            spdlog::warn("Inventory was already taken from '{}'",
+                         this->base_path.string());
+        }
+
+        return std::expected<void, Error>{};
+    }
+
     this->base_path = base_path;
 
-    // load manifests
-    for (const std::filesystem::directory_entry& entry :
-         std::filesystem::recursive_directory_iterator(base_path)) {
-        auto path = entry.path();
-        if (path.extension() == ".xml" || path.extension() == ".resrc") {
-            auto result = this->loadResourceManifest(path);
-            if (!result) {
-                return std::unexpected(result.error());
+    ThreadPool* thread_pool = ThreadPool::getInstance();
+
+    std::optional<InventorySnapshot> snapshot;
+    if (!this->inventory_snapshot_path.empty()) {
+        snapshot = InventorySnapshot::load(this->inventory_snapshot_path);
+        if (snapshot && snapshot->getBasePath() != base_path.string()) {
+            snapshot.reset();
+        }
+    }
+
+    // adding or removing a manifest changes the write time of its directory,
+    // so if none of them changed the manifests from last time are still all
+    // there is and the walk can be skipped
+    bool directories_changed = !snapshot;
+    if (snapshot) {
+        for (auto& directory : snapshot->getDirectories()) {
+            if (InventoryStamp::take(directory.path) != directory) {
+                directories_changed = true;
+                break;
             }
-        } else if (path.extension() == ".atlas") {
-            auto result = this->loadAtlasManifest(path);
-            if (!result) {
-                return std::unexpected(result.error());
+        }
+    }
+
+    std::vector<std::filesystem::path> manifest_paths;
+    std::vector<InventoryStamp> directories;
+    if (directories_changed) {
+        ResourceManager::discoverManifests(base_path, manifest_paths,
+                                           directories);
+    } else {
+        directories = snapshot->getDirectories();
+        for (auto& manifest : snapshot->getManifests()) {
+            manifest_paths.push_back(manifest.path);
+        }
+    }
+
+    // parse manifests in batches, every batch fills its own list so nothing
+    // is shared until the merge below
+    struct ManifestResult {
+            std::optional<InventoryStamp> stamp;
+            size_t sprites_begin;
+            size_t sprites_end;
+            size_t items_begin;
+            size_t items_end;
+            bool parsed;
+    };
+
+    struct ManifestBatch {
+            ResourceList resources;
+            std::vector<ManifestResult> manifests;
+            std::expected<void, Error> result;
+    };
+
+    size_t batch_count = std::min(manifest_paths.size(),
+                                  thread_pool->getThreadCount() * 4);
+    std::vector<std::future<ManifestBatch>> batches;
+    for (size_t i = 0; i < batch_count; ++i) {
+        size_t begin = manifest_paths.size() * i / batch_count;
+        size_t end = manifest_paths.size() * (i + 1) / batch_count;
+
+        batches.push_back(thread_pool->submit([this, &manifest_paths,
+                                               &snapshot, begin, end] {
+            ManifestBatch batch;
+            for (size_t j = begin; j < end; ++j) {
+                ManifestResult manifest = {
+                    InventoryStamp::take(manifest_paths[j]),
+                    batch.resources.sprites.size(),
+                    0,
+                    batch.resources.items.size(),
+                    0,
+                    false};
+
+                // unchanged manifests come straight out of the snapshot
+                bool from_snapshot = false;
+                if (snapshot && manifest.stamp) {
+                    if (auto index = snapshot->findManifest(*manifest.stamp)) {
+                        auto entries = snapshot->getEntries(*index);
+                        if (entries) {
+                            for (auto& entry : *entries) {
+                                addInventoryEntry(entry, batch.resources);
+                            }
+
+                            from_snapshot = true;
+                        }
+                    }
+                }
+
+                if (!from_snapshot) {
+                    manifest.parsed = true;
+                    batch.result =
+                        this->loadManifest(manifest_paths[j], batch.resources);
+                    if (!batch.result) {
+                        break;
+                    }
+                }
+
+                manifest.sprites_end = batch.resources.sprites.size();
+                manifest.items_end = batch.resources.items.size();
+                batch.manifests.push_back(std::move(manifest));
+            }
+
+            return batch;
+        }));
+    }
+
+    std::vector<ManifestBatch> results;
+    for (auto& future : batches) {
+        results.push_back(future.get());
+    }
+
+    bool manifests_changed = directories_changed;
+    size_t sprite_count = 0;
+    size_t item_count = 0;
+    for (auto& batch : results) {
+        if (!batch.result) {
+            return std::unexpected(batch.result.error());
+        }
+
+        for (auto& manifest : batch.manifests) {
+            manifests_changed |= manifest.parsed;
+        }
+
+        sprite_count += batch.resources.sprites.size();
+        item_count += batch.resources.items.size();
+    }
+
+    // record what was found for next time, before the merge takes the ids
+    if (manifests_changed && !this->inventory_snapshot_path.empty()) {
+        InventorySnapshotWriter writer(base_path.string());
+        for (auto& directory : directories) {
+            writer.addDirectory(directory);
+        }
+
+        for (auto& batch : results) {
+            for (auto& manifest : batch.manifests) {
+                if (!manifest.stamp) {
+                    continue;
+                }
+
+                std::vector<InventoryEntry> entries;
+                for (size_t i = manifest.sprites_begin;
+                     i < manifest.sprites_end; ++i) {
+                    auto& [id, sprite_resource] = batch.resources.sprites[i];
+                    entries.push_back(createInventoryEntry(id, sprite_resource));
+                }
+
+                for (size_t i = manifest.items_begin; i < manifest.items_end;
+                     ++i) {
+                    auto& [id, item_resource] = batch.resources.items[i];
+                    entries.push_back(createInventoryEntry(id, item_resource));
+                }
+
+                writer.addManifest(*manifest.stamp, entries);
             }
-        } else if (path.extension() == ".wog2" &&
-                   path.parent_path().stem() == "items") {
-            ItemResource resource(path.string());
-            std::string id = "GOOFORGE_ITEM_RESOURCE_" +
-                             path.replace_extension("").filename().string();
+        }
+
+        // the old snapshot is still mapped, and windows won't rename over a
+        // file that's mapped. everything taken from it has been copied
+        snapshot.reset();
+
+        if (writer.write(this->inventory_snapshot_path)) {
+            spdlog::info("Wrote inventory snapshot to '{}'",
+                         this->inventory_snapshot_path.string());
+        }
+    }
+
+    // every pool gets its one allocation up front, nothing may be added past
+    // this or the pointers handed out would move
+    this->sprite_pool.reserve(sprite_count);
+    this->item_pool.reserve(item_count);
+    this->ball_template_pool.reserve(GooBall::ball_name_to_type.size());
+    this->terrain_templates_pool.reserve(1);
+    this->resource_handles.reserve(sprite_count + item_count +
+                                   GooBall::ball_name_to_type.size() + 1);
+
+    // merge in discovery order so the first definition of an id still wins
+    for (auto& batch : results) {
+        for (auto& [id, sprite_resource] : batch.resources.sprites) {
+            this->addResource(std::move(id), std::move(sprite_resource));
+        }
 
-            this->resources.insert({id, new Resource(resource)});
+        for (auto& [id, item_resource] : batch.resources.items) {
+            ItemResource* added_item_resource =
+                this->addResource(std::move(id), std::move(item_resource));
+
+            // items are named after their uuid
+            if (added_item_resource) {
+                auto key = ItemKey::fromUUID(
+                    std::filesystem::path(added_item_resource->getPath())
+                        .stem()
+                        .string());
+                if (key) {
+                    this->items.insert({*key, added_item_resource});
+                }
+            }
         }
     }
 
@@ -186,39 +781,350 @@ std::expected<void, Error> ResourceManager::takeInventory(
     for (auto pair : GooBall::ball_name_to_type) {
         std::string id = "GOOFORGE_BALL_TEMPLATE_RESOURCE_" +
                          std::to_string(static_cast<int>(pair.second));
-        BallTemplateResource resource(
-            (base_path / "res/balls/" / pair.first / "ball.wog2").string());
+        BallTemplateResource* ball_template_resource = this->addResource(
+            std::move(id),
+            BallTemplateResource(
+                (base_path / "res/balls/" / pair.first / "ball.wog2")
+                    .string()));
+        if (!ball_template_resource) {
+            continue;
+        }
 
-        this->resources.insert({id, new Resource(resource)});
+        size_t index = static_cast<size_t>(pair.second);
+        if (index >= this->ball_templates.size()) {
+            this->ball_templates.resize(index + 1, nullptr);
+        }
+
+        this->ball_templates[index] = ball_template_resource;
     }
 
     // load terrain templates
     std::filesystem::path terrain_path = base_path / "res/terrain/terrain.wog2";
-    TerrainTemplatesResource terrain_templates_resource(terrain_path.string());
-    this->resources.insert({"GOOFORGE_TERRAIN_TEMPLATES_RESOURCE",
-                            new Resource(terrain_templates_resource)});
+    this->terrain_templates =
+        this->addResource("GOOFORGE_TERRAIN_TEMPLATES_RESOURCE",
+                          TerrainTemplatesResource(terrain_path.string()));
+
+    spdlog::info("Took inventory of {} sprites and {} items", sprite_count,
+                 item_count);
+
+    this->indexResourcePaths();
+    this->watcher.watch(base_path);
+
+    // the item catalog fills in behind this, the picker shows whatever has
+    // been indexed so far
+    std::vector<std::filesystem::path> item_paths;
+    item_paths.reserve(this->item_pool.size());
+    for (auto& item_resource : this->item_pool) {
+        item_paths.push_back(item_resource.getPath());
+    }
+
+    ItemCatalog::getInstance()->startIndexing(
+        std::move(item_paths),
+        this->inventory_snapshot_path.empty()
+            ? std::filesystem::path()
+            : this->inventory_snapshot_path.parent_path() /
+                  "item_catalog.snapshot");
+
+    return std::expected<void, Error>{};
+}
+
+bool ResourceManager::hasInventory() const {
+    return !this->resource_handles.empty();
+}
+
+const std::filesystem::path& ResourceManager::getBasePath() const {
+    return this->base_path;
+}
+
+std::expected<BallTemplateResource*, Error> ResourceManager::getBallTemplate(
+    GooBallType type) {
+    size_t index = static_cast<size_t>(type);
+    if (index >= this->ball_templates.size() || !this->ball_templates[index]) {
+        return std::unexpected(ResourceNotFoundError(
+            "GOOFORGE_BALL_TEMPLATE_RESOURCE_" + std::to_string(index)));
+    }
+
+    return this->ball_templates[index];
+}
+
+std::expected<ItemResource*, Error> ResourceManager::getItem(
+    std::string_view uuid) {
+    if (auto key = ItemKey::fromUUID(uuid)) {
+        auto it = this->items.find(*key);
+        if (it != this->items.end()) {
+            return it->second;
+        }
+    }
+
+    // items that aren't named after a uuid only have a string id
+    return this->getResource<ItemResource>("GOOFORGE_ITEM_RESOURCE_" +
+                                           std::string(uuid));
+}
+
+std::expected<TerrainTemplatesResource*, Error>
+ResourceManager::getTerrainTemplates() {
+    if (!this->terrain_templates) {
+        return std::unexpected(
+            ResourceNotFoundError("GOOFORGE_TERRAIN_TEMPLATES_RESOURCE"));
+    }
+
+    return this->terrain_templates;
+}
+
+BaseResource* ResourceManager::getResource(ResourceHandle handle) {
+    switch (handle.type) {
+        case ResourceType::SPRITE:
+            return &this->sprite_pool[handle.index];
+        case ResourceType::BALL_TEMPLATE:
+            return &this->ball_template_pool[handle.index];
+        case ResourceType::ITEM:
+            return &this->item_pool[handle.index];
+        case ResourceType::TERRAIN_TEMPLATES:
+            return &this->terrain_templates_pool[handle.index];
+    }
+
+    return nullptr;
+}
+
+void ResourceManager::indexResourcePaths() {
+    auto index_pool = [this](auto& pool) {
+        using T = std::remove_reference_t<decltype(pool[0])>;
+        for (size_t i = 0; i < pool.size(); ++i) {
+            if constexpr (std::is_same_v<T, SpriteResource>) {
+                if (pool[i].isAtlasSprite()) {
+                    continue;
+                }
+            }
+
+            std::string path = std::filesystem::path(pool[i].getPath())
+                                   .lexically_normal()
+                                   .string();
+            this->path_handles[std::move(path)].push_back(
+                ResourceHandle{ResourceManager::getResourceType<T>(),
+                               static_cast<uint32_t>(i)});
+        }
+    };
+
+    index_pool(this->sprite_pool);
+    index_pool(this->ball_template_pool);
+    index_pool(this->item_pool);
+}
+
+void ResourceManager::reloadChangedResources() {
+    std::vector<BaseResource*> reloaded_resources;
+    for (auto& path : this->watcher.poll()) {
+        auto it = this->path_handles.find(path.lexically_normal().string());
+        if (it == this->path_handles.end()) {
+            continue;
+        }
+
+        for (ResourceHandle handle : it->second) {
+            BaseResource* resource = this->getResource(handle);
+
+            // anything that isn't loaded reads the new file when it's next
+            // used
+            if (!resource->isLoaded()) {
+                continue;
+            }
+
+            // a half saved file won't parse, the old contents are kept until
+            // the next save
+            if (!resource->reload()) {
+                continue;
+            }
+
+            spdlog::info("Reloaded '{}'", resource->getPath());
+            reloaded_resources.push_back(resource);
+        }
+    }
+
+    // entities can point into what was just reloaded, so they're refreshed
+    // before anything else gets to use them
+    this->refreshResourceUsers(reloaded_resources);
+}
+
+void ResourceManager::setEntityResources(Entity* entity,
+                                         std::vector<BaseResource*> resources) {
+    this->removeEntityResources(entity);
+
+    for (BaseResource* resource : resources) {
+        this->resource_users[resource].insert(entity);
+    }
+
+    this->entity_resources[entity] = std::move(resources);
+}
+
+void ResourceManager::removeEntityResources(Entity* entity) {
+    auto it = this->entity_resources.find(entity);
+    if (it == this->entity_resources.end()) {
+        return;
+    }
+
+    for (BaseResource* resource : it->second) {
+        auto users = this->resource_users.find(resource);
+        if (users == this->resource_users.end()) {
+            continue;
+        }
+
+        users->second.erase(entity);
+        if (users->second.empty()) {
+            this->resource_users.erase(users);
+        }
+    }
+
+    this->entity_resources.erase(it);
+}
+
+const std::unordered_map<const BaseResource*, std::unordered_set<Entity*>>&
+ResourceManager::getResourceUsage() const {
+    return this->resource_users;
+}
+
+void ResourceManager::refreshResourceUsers(
+    const std::vector<BaseResource*>& resources) {
+    // refreshing changes the index, so the users are collected first
+    std::unordered_set<Entity*> users;
+    for (BaseResource* resource : resources) {
+        auto it = this->resource_users.find(resource);
+        if (it != this->resource_users.end()) {
+            users.insert(it->second.begin(), it->second.end());
+        }
+    }
+
+    for (Entity* user : users) {
+        user->refresh();
+    }
+}
+
+void ResourceManager::setInventorySnapshotPath(std::filesystem::path path) {
+    this->inventory_snapshot_path = path;
+}
+
+bool ResourceManager::isManifestPath(const std::filesystem::path& path) {
+    return path.extension() == ".xml" || path.extension() == ".resrc" ||
+           path.extension() == ".atlas" ||
+           (path.extension() == ".wog2" &&
+            path.parent_path().stem() == "items");
+}
+
+void ResourceManager::discoverManifests(
+    const std::filesystem::path& base_path,
+    std::vector<std::filesystem::path>& manifest_paths,
+    std::vector<InventoryStamp>& directories) {
+    // one directory's own entries, in the order they were listed. each
+    // subdirectory points at the listing it gets once it's been walked
+    struct Listing {
+            std::optional<InventoryStamp> stamp;
+            std::vector<std::filesystem::path> manifest_paths;
+            std::vector<std::filesystem::path> subdirectories;
+            // per entry, the subdirectory it is or -1 for a manifest
+            std::vector<int64_t> entries;
+            std::vector<size_t> children;
+    };
+
+    auto listDirectory = [](std::filesystem::path directory) {
+        Listing listing;
+        listing.stamp = InventoryStamp::take(directory);
+        std::error_code error;
+        for (const std::filesystem::directory_entry& entry :
+             std::filesystem::directory_iterator(directory, error)) {
+            // like a recursive walk, linked directories aren't followed
+            if (entry.is_directory() && !entry.is_symlink()) {
+                listing.entries.push_back(listing.subdirectories.size());
+                listing.subdirectories.push_back(entry.path());
+            } else if (ResourceManager::isManifestPath(entry.path())) {
+                listing.entries.push_back(-1);
+                listing.manifest_paths.push_back(entry.path());
+            }
+        }
+
+        return listing;
+    };
+
+    // every directory is listed on its own task, and its subdirectories are
+    // queued from here as it comes back, since the tasks can't wait on each
+    // other. nearly everything is under res/, so splitting up only the top
+    // level would leave one task doing most of the walk
+    ThreadPool* thread_pool = ThreadPool::getInstance();
+    std::vector<Listing> listings;
+    std::deque<std::pair<size_t, std::future<Listing>>> walks;
+    listings.emplace_back();
+    walks.push_back({0, thread_pool->submit([listDirectory, base_path] {
+                         return listDirectory(base_path);
+                     })});
+
+    while (!walks.empty()) {
+        auto [index, future] = std::move(walks.front());
+        walks.pop_front();
+        listings[index] = future.get();
+
+        // adding listings moves them, so nothing is held onto across it
+        std::vector<std::filesystem::path> subdirectories =
+            std::move(listings[index].subdirectories);
+        for (auto& subdirectory : subdirectories) {
+            listings[index].children.push_back(listings.size());
+            listings.emplace_back();
+            walks.push_back(
+                {listings.size() - 1,
+                 thread_pool->submit([listDirectory, subdirectory] {
+                     return listDirectory(subdirectory);
+                 })});
+        }
+    }
+
+    // flattened in the same order a recursive walk would have found them,
+    // the first definition of an id wins so the order matters
+    auto append = [&](auto& append, size_t index) -> void {
+        Listing& listing = listings[index];
+        if (listing.stamp) {
+            directories.push_back(std::move(*listing.stamp));
+        }
+
+        size_t manifest = 0;
+        for (int64_t entry : listing.entries) {
+            if (entry == -1) {
+                manifest_paths.push_back(
+                    std::move(listing.manifest_paths[manifest]));
+                ++manifest;
+            } else {
+                append(append, listing.children[entry]);
+            }
+        }
+    };
+
+    append(append, 0);
+}
+
+std::expected<void, Error> ResourceManager::loadManifest(
+    const std::filesystem::path& path, ResourceList& resources) const {
+    if (path.extension() == ".xml" || path.extension() == ".resrc") {
+        return this->loadResourceManifest(path, resources);
+    } else if (path.extension() == ".atlas") {
+        return this->loadAtlasManifest(path, resources);
+    }
+
+    // item files are registered as is, they're only parsed when used
+    std::string id = "GOOFORGE_ITEM_RESOURCE_" + path.stem().string();
+    resources.items.push_back({id, ItemResource(path.string())});
 
     return std::expected<void, Error>{};
 }
 
 std::expected<void, Error> ResourceManager::loadResourceManifest(
-    std::filesystem::path& path) {
-    std::ifstream file(path);
+    const std::filesystem::path& path, ResourceList& resources) const {
+    auto file = MappedFile::open(path);
     if (!file) {
-        return std::unexpected(FileOpenError(path.string()));
+        return std::unexpected(file.error());
     }
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string xml_content = buffer.str();
-    // they left out quotes on one of the ids for some reason, which messes with
-    // pugixml so we have to fix it with this regex replace
-    // TODO: check if this fails?
-    xml_content = std::regex_replace(xml_content, std::regex(R"(id=(\w+))"),
-                                     R"(id="\1")");
+    // the mapping is read only, so the repaired copy is what pugixml parses
+    // in place
+    std::string xml_content =
+        repairManifest(std::string_view(file->getData(), file->getSize()));
 
     pugi::xml_document document;
-    pugi::xml_parse_result result = document.load_string(xml_content.c_str());
+    pugi::xml_parse_result result =
+        document.load_buffer_inplace(xml_content.data(), xml_content.size());
 
     if (!result) {
         return std::unexpected(
@@ -246,9 +1152,8 @@ std::expected<void, Error> ResourceManager::loadResourceManifest(
                 resource_path_base / image.attribute("path").as_string();
             resource_path.replace_extension(".image");
 
-            SpriteResource sprite_resource(resource_path.string());
-            this->resources.insert(
-                {resource_id, new Resource(sprite_resource)});
+            resources.sprites.push_back(
+                {resource_id, SpriteResource(resource_path.string())});
         }
     }
 
@@ -256,95 +1161,304 @@ std::expected<void, Error> ResourceManager::loadResourceManifest(
 }
 
 std::expected<void, Error> ResourceManager::loadAtlasManifest(
-    std::filesystem::path& path) {
-    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    const std::filesystem::path& path, ResourceList& resources) const {
+    auto file = MappedFile::open(path);
     if (!file) {
-        return std::unexpected(FileOpenError(path.string()));
+        return std::unexpected(file.error());
     }
 
-    size_t size = file.tellg();
-    file.seekg(0);
-
-    char* data = new char[size];
-    file.read(data, size);
-
-    BufferStream stream(data, size);
-    stream.seek(8); // skip header
+    // records are parsed in place out of the mapping
+    BufferStream stream(file->getData(), file->getSize());
+    auto header = stream.trySkip(8);
+    if (!header) {
+        return std::unexpected(header.error());
+    }
 
-    path.replace_extension("");
-    SpriteResource atlas_sprite(path.string()); // chop off .atlas
-    this->resources.insert({path.string(), new Resource(atlas_sprite)});
+    std::string atlas_path =
+        std::filesystem::path(path).replace_extension("").string();
+    // chop off .atlas
+    resources.sprites.push_back({atlas_path, SpriteResource(atlas_path)});
 
-    uint32_t number_of_files = stream.read<uint32_t>();
-    for (size_t i = 0; i < number_of_files; ++i) {
-        std::string id;
-        for (size_t j = 0; j < 64; ++j) {
-            char character = stream.read<char>();
+    auto number_of_files = stream.tryRead<uint32_t>();
+    if (!number_of_files) {
+        return std::unexpected(number_of_files.error());
+    }
 
-            if (character) {
-                id += character;
-            }
-        }
+    // the whole table is checked up front, so the reads below can't run off
+    // the end of the file
+    if (*number_of_files > stream.remaining() / sizeof(AtlasRecord)) {
+        return std::unexpected(BufferReadError(
+            file->getSize() - stream.remaining(),
+            static_cast<size_t>(*number_of_files) * sizeof(AtlasRecord),
+            file->getSize()));
+    }
 
+    for (uint32_t i = 0; i < *number_of_files; ++i) {
+        std::string_view id =
+            stream.readFixedString<sizeof(AtlasRecord::id)>();
         uint32_t x_offset = stream.read<uint32_t>();
         uint32_t y_offset = stream.read<uint32_t>();
         uint32_t x_size = stream.read<uint32_t>();
         uint32_t y_size = stream.read<uint32_t>();
-
         sf::IntRect rect(x_offset, y_offset, x_size, y_size);
 
-        SpriteResource sprite_resource(path.string(), rect);
-        this->resources.insert({id, new Resource(sprite_resource)});
+        resources.sprites.push_back(
+            {std::string(id), SpriteResource(atlas_path, rect)});
     }
 
     return std::expected<void, Error>{};
 }
 
-void ResourceManager::unloadAll() {
-    for (auto& [id, resource] : this->resources) {
-        BaseResource* base_resource = std::visit(
-            [](auto& derived_resource) -> BaseResource* {
-                return &derived_resource;
-            },
-            *resource);
+bool SpritePrefetch::isReady() const {
+    for (auto& [texture_resource, decode] : this->decodes) {
+        if (decode.wait_for(std::chrono::seconds(0)) !=
+            std::future_status::ready) {
+            return false;
+        }
+    }
 
-        base_resource->unload();
+    return true;
+}
+
+void SpritePrefetch::wait() const {
+    for (auto& [texture_resource, decode] : this->decodes) {
+        decode.wait();
     }
 }
 
-template <>
-std::expected<std::vector<ItemResource*>, Error> ResourceManager::getResources(
-    std::string filter, int limit) {
-    std::vector<ItemResource*> filtered_resources;
+// decoding is the expensive part and can happen anywhere, so it's started on
+// the pool here and the upload is left for finishPrefetch on the main thread
+SpritePrefetch ResourceManager::prefetchSprites(
+    const std::vector<SpriteResource*>& sprite_resources) {
+    // atlas sprites share their atlas' texture, so dedupe on the resource
+    // that actually owns the texture
+    std::unordered_set<SpriteResource*> texture_resources;
+    for (SpriteResource* sprite_resource : sprite_resources) {
+        SpriteResource* texture_resource =
+            sprite_resource->getTextureResource();
+        if (texture_resource && !texture_resource->isLoaded()) {
+            texture_resources.insert(texture_resource);
+        }
+    }
 
-    std::transform(filter.begin(), filter.end(), filter.begin(),
-                   [](unsigned char c) { return std::tolower(c); });
+    SpritePrefetch prefetch;
+    for (auto texture_resource : texture_resources) {
+        prefetch.decodes.push_back(
+            {texture_resource, ThreadPool::getInstance()->submit(
+                                   [texture_resource] {
+                                       return decodeOnPool(texture_resource);
+                                   })});
+    }
 
-    for (auto& [id, resource] : this->resources) {
-        if (ItemResource* item_resource = std::get_if<ItemResource>(resource)) {
-            auto item_result = item_resource->get();
-            if (!item_result) {
-                continue; // skip this resource if it fails to load, todo: figure out why this is happening
-                //return std::unexpected(item_result.error());
-            }
+    return prefetch;
+}
+
+void ResourceManager::finishPrefetch(SpritePrefetch& prefetch) {
+    size_t uploads = 0;
+    for (auto& [texture_resource, decode] : prefetch.decodes) {
+        auto image = decode.get();
+        // whoever asks for it later will report the error. an async decode
+        // may also have got there first
+        if (!image || texture_resource->isLoaded()) {
+            continue;
+        }
+
+        texture_resource->upload(*image);
+        ++uploads;
+    }
+
+    prefetch.decodes.clear();
 
-            ItemInfoFile* item_info = *item_result;
-            std::string item_name = item_info->items[0].name; // not safe bruh
-            std::transform(item_name.begin(), item_name.end(),
-                           item_name.begin(),
-                           [](unsigned char c) { return std::tolower(c); });
+    spdlog::info("Prefetched {} textures", uploads);
+}
+
+void ResourceManager::setAsyncSpriteLoading(bool async) {
+    this->async_sprite_loading = async;
+}
 
-            if (filter.empty() || item_name.find(filter) != std::string::npos) {
-                filtered_resources.push_back(item_resource);
+bool ResourceManager::getAsyncSpriteLoading() const {
+    return this->async_sprite_loading;
+}
+
+const sf::Texture* ResourceManager::getPlaceholderTexture() {
+    if (!this->placeholder_texture) {
+        // small grey checkerboard, shared by every sprite that is still loading
+        sf::Image image;
+        image.create(16, 16, sf::Color(160, 160, 160, 128));
+        for (unsigned int y = 0; y < 16; ++y) {
+            for (unsigned int x = 0; x < 16; ++x) {
+                if ((x / 8 + y / 8) % 2) {
+                    image.setPixel(x, y, sf::Color(96, 96, 96, 128));
+                }
             }
         }
 
-        if (limit > 0 && filtered_resources.size() >= limit) {
+        this->placeholder_texture = new sf::Texture();
+        this->placeholder_texture->loadFromImage(image);
+    }
+
+    return this->placeholder_texture;
+}
+
+void ResourceManager::queueDecode(SpriteResource* sprite_resource) {
+    size_t generation = this->generation;
+
+    ThreadPool::getInstance()->submit([this, sprite_resource, generation] {
+        // nobody waits on this task's future, so the error has to be handed
+        // over here or the sprite would never finish loading
+        std::expected<BoyImage, Error> image = decodeOnPool(sprite_resource);
+
+        std::lock_guard lock(this->decoded_mutex);
+        this->decoded_sprites.push_back(
+            {sprite_resource, generation, std::move(image)});
+    });
+}
+
+void ResourceManager::processUploads(size_t max_uploads) {
+    std::vector<DecodedSprite> uploads;
+
+    {
+        std::lock_guard lock(this->decoded_mutex);
+        size_t count = std::min(max_uploads, this->decoded_sprites.size());
+        std::move(this->decoded_sprites.begin(),
+                  this->decoded_sprites.begin() + count,
+                  std::back_inserter(uploads));
+        this->decoded_sprites.erase(this->decoded_sprites.begin(),
+                                    this->decoded_sprites.begin() + count);
+    }
+
+    for (auto& decoded_sprite : uploads) {
+        // decoded before the last unloadAll, nobody is waiting on it anymore
+        if (decoded_sprite.generation != this->generation) {
+            continue;
+        }
+
+        // something else (like a prefetch) got to it first
+        if (decoded_sprite.sprite_resource->isLoaded()) {
+            continue;
+        }
+
+        // the placeholder stays, but the next get() reports the error
+        if (!decoded_sprite.image) {
+            Error error = decoded_sprite.image.error();
+            BaseError* base_error = std::visit(
+                [](auto& derived_error) -> BaseError* {
+                    return &derived_error;
+                },
+                error);
+            spdlog::error("Failed to load '{}': {}",
+                          decoded_sprite.sprite_resource->getPath(),
+                          base_error->getMessage());
+            decoded_sprite.sprite_resource->fail(std::move(error));
+            continue;
+        }
+
+        decoded_sprite.sprite_resource->upload(*decoded_sprite.image);
+    }
+}
+
+void ResourceManager::update() {
+    ++this->frame;
+
+    this->processUploads(GOOFORGE_MAX_TEXTURE_UPLOADS_PER_FRAME);
+    this->evictTextures();
+    ThumbnailAtlas::getInstance()->update();
+}
+
+uint64_t ResourceManager::getFrame() const { return this->frame; }
+
+void ResourceManager::setTextureBudget(size_t bytes) {
+    this->texture_budget = bytes;
+}
+
+size_t ResourceManager::getTextureBytes() const { return this->texture_bytes; }
+
+// nullptr if the texture isn't loaded
+SpriteResource* ResourceManager::getTextureOwner(const sf::Texture* texture) {
+    for (auto sprite_resource : this->loaded_textures) {
+        if (sprite_resource->getTexture() == texture) {
+            return sprite_resource;
+        }
+    }
+
+    return nullptr;
+}
+
+void ResourceManager::trackTexture(SpriteResource* sprite_resource) {
+    this->loaded_textures.insert(sprite_resource);
+    this->texture_bytes += sprite_resource->getByteSize();
+}
+
+void ResourceManager::untrackTexture(SpriteResource* sprite_resource) {
+    this->loaded_textures.erase(sprite_resource);
+    this->texture_bytes -= sprite_resource->getByteSize();
+}
+
+// evicts the least recently used textures until we're back under budget,
+// anything drawn in the last few frames is left alone even if that means
+// staying over it
+void ResourceManager::evictTextures() {
+    if (this->texture_bytes <= this->texture_budget) {
+        return;
+    }
+
+    std::vector<SpriteResource*> candidates;
+    for (auto sprite_resource : this->loaded_textures) {
+        if (this->frame - sprite_resource->getLastUsedFrame() >
+            GOOFORGE_TEXTURE_EVICTION_IDLE_FRAMES) {
+            candidates.push_back(sprite_resource);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](SpriteResource* x, SpriteResource* y) {
+                  return x->getLastUsedFrame() < y->getLastUsedFrame();
+              });
+
+    size_t evicted = 0;
+    for (auto sprite_resource : candidates) {
+        if (this->texture_bytes <= this->texture_budget) {
             break;
         }
+
+        sprite_resource->evict();
+        ++evicted;
+
+        auto users = this->resource_users.find(sprite_resource);
+        if (users != this->resource_users.end()) {
+            for (Entity* user : users->second) {
+                user->notifySpriteEvicted();
+            }
+        }
     }
 
-    return filtered_resources;
+    if (evicted) {
+        spdlog::info("Evicted {} textures, {} MB still loaded", evicted,
+                     this->texture_bytes / (1024 * 1024));
+    }
+}
+
+void ResourceManager::unloadAll() {
+    ++this->generation;
+
+    // thumbnails are keyed on texture addresses, which are about to be reused
+    ThumbnailAtlas::getInstance()->clear();
+
+    for (auto& sprite_resource : this->sprite_pool) {
+        sprite_resource.unload();
+    }
+
+    for (auto& ball_template_resource : this->ball_template_pool) {
+        ball_template_resource.unload();
+    }
+
+    for (auto& item_resource : this->item_pool) {
+        item_resource.unload();
+    }
+
+    for (auto& terrain_templates_resource : this->terrain_templates_pool) {
+        terrain_templates_resource.unload();
+    }
 }
 
 ResourceManager* ResourceManager::instance = nullptr;
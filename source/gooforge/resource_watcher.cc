@@ -0,0 +1,174 @@
+// codeshaunted - gooforge
+// source/gooforge/resource_watcher.cc
+// contains ResourceWatcher definitions
+// Copyright (C) 2024 codeshaunted
+//
+// This file is part of gooforge.
+// gooforge is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// gooforge is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with gooforge. If not, see <https://www.gnu.org/licenses/>.
+
+#include "resource_watcher.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "spdlog.h"
+
+#include "thread_pool.hh"
+
+namespace gooforge {
+
+ResourceWatcher::~ResourceWatcher() { this->stop(); }
+
+void ResourceWatcher::watch(std::filesystem::path path) {
+    this->stop();
+
+#ifdef __linux__
+    this->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (this->fd < 0) {
+        spdlog::warn("Failed to watch '{}' for changes: {}", path.string(),
+                     std::strerror(errno));
+        return;
+    }
+
+    this->setup = ThreadPool::getInstance()->submit([this, path] {
+        this->addDirectory(path);
+        spdlog::info("Watching {} directories for resource changes",
+                     this->directories.size());
+    });
+#endif
+}
+
+void ResourceWatcher::stop() {
+    if (this->setup.valid()) {
+        this->setup.wait();
+        this->setup = std::future<void>();
+    }
+
+#ifdef __linux__
+    if (this->fd >= 0) {
+        close(this->fd);
+    }
+#endif
+
+    this->fd = -1;
+    this->directories.clear();
+}
+
+std::vector<std::filesystem::path> ResourceWatcher::poll() {
+    std::vector<std::filesystem::path> paths;
+
+#ifdef __linux__
+    if (this->fd < 0 ||
+        (this->setup.valid() && this->setup.wait_for(std::chrono::seconds(0)) !=
+                                    std::future_status::ready)) {
+        return paths;
+    }
+
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        ssize_t length = read(this->fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            break; // EAGAIN once everything has been read
+        }
+
+        for (char* pointer = buffer; pointer < buffer + length;) {
+            inotify_event* event = reinterpret_cast<inotify_event*>(pointer);
+            pointer += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                spdlog::warn("Too many resource changes at once, some were "
+                             "missed");
+                continue;
+            }
+
+            auto it = this->directories.find(event->wd);
+            if (it == this->directories.end()) {
+                continue;
+            }
+
+            // the directory was removed
+            if (event->mask & IN_IGNORED) {
+                this->directories.erase(it);
+                continue;
+            }
+
+            if (event->len == 0) {
+                continue;
+            }
+
+            std::filesystem::path path = it->second / event->name;
+            if (event->mask & IN_ISDIR) {
+                this->addDirectory(path);
+            } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                // editors that save through a temporary file show up as a
+                // move, everything else as a close after writing
+                paths.push_back(std::move(path));
+            }
+        }
+    }
+
+    std::sort(paths.begin(), paths.end());
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+#endif
+
+    return paths;
+}
+
+// watches the directory and everything below it
+void ResourceWatcher::addDirectory(const std::filesystem::path& path) {
+#ifdef __linux__
+    // files only matter once they've been written, directories as soon as
+    // they show up so their contents get watched too
+    uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR;
+
+    int wd = inotify_add_watch(this->fd, path.c_str(), mask);
+    if (wd < 0) {
+        spdlog::warn("Failed to watch '{}' for changes: {}", path.string(),
+                     std::strerror(errno));
+        return;
+    }
+
+    this->directories[wd] = path;
+
+    std::error_code error;
+    for (auto it = std::filesystem::recursive_directory_iterator(
+             path,
+             std::filesystem::directory_options::skip_permission_denied,
+             error);
+         !error && it != std::filesystem::recursive_directory_iterator();
+         it.increment(error)) {
+        std::error_code status_error;
+        if (!it->is_directory(status_error)) {
+            continue;
+        }
+
+        wd = inotify_add_watch(this->fd, it->path().c_str(), mask);
+        if (wd < 0) {
+            spdlog::warn("Failed to watch '{}' for changes: {}",
+                         it->path().string(), std::strerror(errno));
+            continue;
+        }
+
+        this->directories[wd] = it->path();
+    }
+#endif
+}
+
+} // namespace gooforge
@@ -28,16 +28,57 @@
 
 namespace gooforge {
 
+std::optional<TerrainGroupResources> TerrainGroup::resolve(
+    const TerrainGroupInfo& info) {
+    ResourceManager* resource_manager = ResourceManager::getInstance();
+    auto template_resource = resource_manager->getTerrainTemplates();
+    if (!template_resource) {
+        return std::nullopt;
+    }
+
+    TerrainTemplateInfoFile* template_info_file =
+        template_resource.value()->getLoaded();
+    if (!template_info_file) {
+        return std::nullopt;
+    }
+
+    int index = 0;
+    for (auto& terrain_template : template_info_file->terrainTypes) {
+        if (terrain_template.uuid == info.typeUuid) {
+            auto sprite_resource =
+                resource_manager->getResource<SpriteResource>(
+                    terrain_template.baseSettings.image.imageId);
+            if (!sprite_resource) {
+                return std::nullopt;
+            }
+
+            return TerrainGroupResources{*template_resource,
+                                         &terrain_template, index,
+                                         *sprite_resource};
+        }
+
+        ++index;
+    }
+
+    return std::nullopt;
+}
+
 std::expected<void, Error> TerrainGroup::setup(TerrainGroupInfo info) {
     this->info = info;
 
     return this->refresh();
 }
 
+std::expected<void, Error> TerrainGroup::setup(
+    TerrainGroupInfo info, const TerrainGroupResources& resources) {
+    this->info = std::move(info);
+
+    return this->link(resources);
+}
+
 std::expected<void, Error> TerrainGroup::refresh() {
     auto template_resource =
-        ResourceManager::getInstance()->getResource<TerrainTemplatesResource>(
-            "GOOFORGE_TERRAIN_TEMPLATES_RESOURCE");
+        ResourceManager::getInstance()->getTerrainTemplates();
     if (!template_resource) {
         return std::unexpected(template_resource.error());
     }
@@ -48,11 +89,13 @@ std::expected<void, Error> TerrainGroup::refresh() {
     }
 
     // TODO: handle not found case
-    size_t index = 0;
+    TerrainGroupResources resources{*template_resource, this->template_info,
+                                    this->info.typeIndex, nullptr};
+    int index = 0;
     for (auto& terrain_template : (*template_info_file)->terrainTypes) {
         if (terrain_template.uuid == this->info.typeUuid) {
-            this->template_info = &terrain_template;
-            this->info.typeIndex = index; // this is kinda cursed
+            resources.template_info = &terrain_template;
+            resources.type_index = index;
             break;
         }
 
@@ -61,17 +104,33 @@ std::expected<void, Error> TerrainGroup::refresh() {
 
     auto sprite_resource =
         ResourceManager::getInstance()->getResource<SpriteResource>(
-            this->template_info->baseSettings.image.imageId);
+            resources.template_info->baseSettings.image.imageId);
     if (!sprite_resource) {
         return std::unexpected(sprite_resource.error());
     }
 
-    auto sprite = sprite_resource.value()->get();
+    resources.sprite_resource = *sprite_resource;
+
+    return this->link(resources);
+}
+
+std::expected<void, Error> TerrainGroup::link(
+    const TerrainGroupResources& resources) {
+    this->template_info = resources.template_info;
+    if (this->info.typeIndex != resources.type_index) {
+        this->info.typeIndex = resources.type_index; // this is kinda cursed
+        this->markInfoDirty();
+    }
+
+    auto sprite = resources.sprite_resource->get();
     if (!sprite) {
         return std::unexpected(sprite.error());
     }
 
     this->display_sprite = *sprite;
+    this->setSpriteResource(resources.sprite_resource);
+    this->useResources(
+        {resources.templates_resource, resources.sprite_resource});
 
     return std::expected<void, Error>{};
 }
@@ -159,6 +218,7 @@ float TerrainGroup::getDepth() const { return this->info.depth; }
 
 void TerrainGroup::setDepth(float depth) {
     this->info.depth = depth;
+    this->markInfoDirty();
 }
 
 TerrainGroupInfo& TerrainGroup::getInfo() { return this->info; }
@@ -194,12 +254,16 @@ std::string TerrainGroup::getTerrainTemplateUUID() {
 
 void TerrainGroup::setTerrainTemplateUUID(std::string uuid) {
     this->info.typeUuid = uuid;
+    this->markInfoDirty();
 
     this->refresh();
 }
 
 int TerrainGroup::getSortOffset() const { return this->info.sortOffset; }
 
-void TerrainGroup::setSortOffset(int offset) { this->info.sortOffset = offset; }
+void TerrainGroup::setSortOffset(int offset) {
+    this->info.sortOffset = offset;
+    this->markInfoDirty();
+}
 
 } // namespace gooforge
\ No newline at end of file
@@ -0,0 +1,269 @@
+// codeshaunted - gooforge
+// source/gooforge/texture_cache.cc
+// contains TextureCache definitions
+// Copyright (C) 2024 codeshaunted
+//
+// This file is part of gooforge.
+// gooforge is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// gooforge is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with gooforge. If not, see <https://www.gnu.org/licenses/>.
+
+#include "texture_cache.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "spdlog.h"
+
+namespace gooforge {
+
+namespace {
+
+// where the pixels start, after the header and the padded source path
+uint64_t getPixelsOffset(const TextureCacheHeader& header) {
+    return sizeof(header) + (header.source_path_size + 7) / 8 * 8;
+}
+
+} // namespace
+
+TextureCache* TextureCache::getInstance() {
+    if (!TextureCache::instance) {
+        TextureCache::instance = new TextureCache();
+    }
+
+    return TextureCache::instance;
+}
+
+void TextureCache::enable(std::filesystem::path directory, uint64_t max_size) {
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        spdlog::error("Failed to create texture cache directory '{}'",
+                      directory.string());
+        return;
+    }
+
+    this->directory = directory;
+    this->max_size = max_size;
+    this->enabled = true;
+
+    this->prune();
+
+    spdlog::info("Texture cache enabled at '{}'", directory.string());
+}
+
+void TextureCache::disable() { this->enabled = false; }
+
+bool TextureCache::isEnabled() const { return this->enabled; }
+
+std::optional<BoyImage> TextureCache::load(
+    const std::filesystem::path& source_path) {
+    TextureCacheHeader expected_header;
+    auto entry_path = this->getEntryPath(source_path, expected_header);
+    if (!entry_path) {
+        return std::nullopt;
+    }
+
+    std::error_code error;
+    if (!std::filesystem::exists(*entry_path, error)) {
+        return std::nullopt;
+    }
+
+    auto file = MappedFile::open(*entry_path);
+    if (!file || file->getSize() < sizeof(TextureCacheHeader)) {
+        return std::nullopt;
+    }
+
+    TextureCacheHeader header;
+    std::memcpy(&header, file->getData(), sizeof(header));
+    uint64_t pixels_offset = getPixelsOffset(header);
+    if (header.magic != expected_header.magic ||
+        header.version != expected_header.version ||
+        header.source_size != expected_header.source_size ||
+        header.source_write_time != expected_header.source_write_time ||
+        header.source_path_size != expected_header.source_path_size ||
+        file->getSize() != pixels_offset + static_cast<uint64_t>(
+                                               header.width) *
+                                               header.height * 4) {
+        return std::nullopt;
+    }
+
+    // another file whose key hashed to the same entry
+    std::string source_path_string = source_path.string();
+    if (std::memcmp(file->getData() + sizeof(header),
+                    source_path_string.data(),
+                    source_path_string.size()) != 0) {
+        return std::nullopt;
+    }
+
+    // bump the write time so pruning sees this entry as recently used
+    std::filesystem::last_write_time(
+        *entry_path, std::filesystem::file_time_type::clock::now(), error);
+
+    return BoyImage::fromMappedFile(std::move(*file), pixels_offset,
+                                    header.width, header.height);
+}
+
+void TextureCache::store(const std::filesystem::path& source_path,
+                         const BoyImage& image) {
+    TextureCacheHeader header;
+    auto entry_path = this->getEntryPath(source_path, header);
+    if (!entry_path) {
+        return;
+    }
+
+    header.width = image.getWidth();
+    header.height = image.getHeight();
+
+    // write to a file unique to this thread and rename it into place, so
+    // nobody can ever map a half written entry
+    std::stringstream thread_id;
+    thread_id << std::this_thread::get_id();
+    std::filesystem::path temporary_path = *entry_path;
+    temporary_path += std::format(".{}.tmp", thread_id.str());
+
+    {
+        std::ofstream file(temporary_path, std::ios::binary);
+        if (!file) {
+            return;
+        }
+
+        std::string source_path_string = source_path.string();
+        std::string padding(
+            getPixelsOffset(header) - sizeof(header) - header.source_path_size,
+            '\0');
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(source_path_string.data(), source_path_string.size());
+        file.write(padding.data(), padding.size());
+        file.write(reinterpret_cast<const char*>(image.getPixels()),
+                   image.getPixelsSize());
+        if (!file) {
+            file.close();
+            std::error_code error;
+            std::filesystem::remove(temporary_path, error);
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary_path, *entry_path, error);
+    if (error) {
+        std::filesystem::remove(temporary_path, error);
+        return;
+    }
+
+    uint64_t new_size =
+        this->size += getPixelsOffset(header) + image.getPixelsSize();
+    if (new_size > this->max_size) {
+        this->prune();
+    }
+}
+
+// deletes the least recently used entries until the cache fits its size cap
+void TextureCache::prune() {
+    if (!this->enabled) {
+        return;
+    }
+
+    // a store that overflows the cap while another thread is already pruning
+    // doesn't need to do it again
+    std::unique_lock lock(this->prune_mutex, std::try_to_lock);
+    if (!lock) {
+        return;
+    }
+
+    struct Entry {
+            std::filesystem::path path;
+            std::filesystem::file_time_type write_time;
+            uint64_t size;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t total_size = 0;
+    std::error_code error;
+    for (auto& directory_entry :
+         std::filesystem::directory_iterator(this->directory, error)) {
+        if (!directory_entry.is_regular_file(error) ||
+            directory_entry.path().extension() != ".texture") {
+            continue;
+        }
+
+        Entry entry = {directory_entry.path(),
+                       directory_entry.last_write_time(error),
+                       directory_entry.file_size(error)};
+        total_size += entry.size;
+        entries.push_back(entry);
+    }
+
+    if (total_size > this->max_size) {
+        std::sort(entries.begin(), entries.end(),
+                  [](const Entry& x, const Entry& y) {
+                      return x.write_time < y.write_time;
+                  });
+
+        size_t removed = 0;
+        for (auto& entry : entries) {
+            if (total_size <= this->max_size) {
+                break;
+            }
+
+            if (std::filesystem::remove(entry.path, error)) {
+                total_size -= entry.size;
+                ++removed;
+            }
+        }
+
+        spdlog::info("Pruned {} entries from the texture cache", removed);
+    }
+
+    this->size = total_size;
+}
+
+std::optional<std::filesystem::path> TextureCache::getEntryPath(
+    const std::filesystem::path& source_path, TextureCacheHeader& header) {
+    if (!this->enabled) {
+        return std::nullopt;
+    }
+
+    std::error_code error;
+    uint64_t source_size = std::filesystem::file_size(source_path, error);
+    if (error) {
+        return std::nullopt;
+    }
+
+    auto source_write_time =
+        std::filesystem::last_write_time(source_path, error);
+    if (error) {
+        return std::nullopt;
+    }
+
+    header.magic = GOOFORGE_TEXTURE_CACHE_MAGIC;
+    header.version = GOOFORGE_TEXTURE_CACHE_VERSION;
+    header.source_size = source_size;
+    header.source_write_time = source_write_time.time_since_epoch().count();
+    header.source_path_size = source_path.string().size();
+
+    size_t key = std::hash<std::string>{}(std::format(
+        "{}|{}|{}", source_path.string(), header.source_size,
+        header.source_write_time));
+
+    return this->directory / std::format("{:016x}.texture", key);
+}
+
+TextureCache* TextureCache::instance = nullptr;
+
+} // namespace gooforge
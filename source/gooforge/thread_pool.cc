@@ -0,0 +1,86 @@
+// codeshaunted - gooforge
+// source/gooforge/thread_pool.cc
+// contains ThreadPool definitions
+// Copyright (C) 2024 codeshaunted
+//
+// This file is part of gooforge.
+// gooforge is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// gooforge is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with gooforge. If not, see <https://www.gnu.org/licenses/>.
+
+#include "thread_pool.hh"
+
+#include <algorithm>
+
+#include "spdlog.h"
+
+namespace gooforge {
+
+ThreadPool::ThreadPool(size_t thread_count) {
+    for (size_t i = 0; i < thread_count; ++i) {
+        this->threads.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(this->mutex);
+        this->stopping = true;
+    }
+
+    this->condition.notify_all();
+
+    for (auto& thread : this->threads) {
+        thread.join();
+    }
+}
+
+ThreadPool* ThreadPool::getInstance() {
+    if (!ThreadPool::instance) {
+        // hardware_concurrency is allowed to return 0 if it can't tell
+        size_t thread_count =
+            std::max(std::thread::hardware_concurrency(), 1u);
+        ThreadPool::instance = new ThreadPool(thread_count);
+        spdlog::info("Thread pool successfully initialized with {} threads",
+                     thread_count);
+    }
+
+    return ThreadPool::instance;
+}
+
+size_t ThreadPool::getThreadCount() const { return this->threads.size(); }
+
+void ThreadPool::work() {
+    while (true) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock lock(this->mutex);
+            this->condition.wait(lock, [this] {
+                return this->stopping || !this->tasks.empty();
+            });
+
+            if (this->stopping && this->tasks.empty()) {
+                return;
+            }
+
+            task = std::move(this->tasks.front());
+            this->tasks.pop_front();
+        }
+
+        task();
+    }
+}
+
+ThreadPool* ThreadPool::instance = nullptr;
+
+} // namespace gooforge
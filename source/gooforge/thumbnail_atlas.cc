@@ -0,0 +1,317 @@
+// codeshaunted - gooforge
+// source/gooforge/thumbnail_atlas.cc
+// contains ThumbnailAtlas definitions
+// Copyright (C) 2024 codeshaunted
+//
+// This file is part of gooforge.
+// gooforge is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// gooforge is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with gooforge. If not, see <https://www.gnu.org/licenses/>.
+
+#include "thumbnail_atlas.hh"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <climits>
+#include <exception>
+
+#include "spdlog.h"
+
+#include "boy_image.hh"
+#include "resource_manager.hh"
+#include "thread_pool.hh"
+
+namespace gooforge {
+
+namespace {
+
+constexpr size_t cells_per_row =
+    GOOFORGE_THUMBNAIL_ATLAS_SIZE / GOOFORGE_THUMBNAIL_SIZE;
+constexpr size_t cells_per_page = cells_per_row * cells_per_row;
+
+// box filter, every thumbnail pixel is the alpha weighted average of the
+// source pixels it covers so transparent edges don't bleed in dark. empty if
+// the rect doesn't cover any of the image
+std::vector<uint8_t> makeThumbnail(const BoyImage& image, sf::IntRect rect) {
+    int image_width = static_cast<int>(image.getWidth());
+    int image_height = static_cast<int>(image.getHeight());
+
+    // clamp the rect to the image, atlas rects aren't always well behaved
+    int left = std::clamp(rect.left, 0, image_width);
+    int top = std::clamp(rect.top, 0, image_height);
+    int source_width = std::clamp(rect.width, 0, image_width - left);
+    int source_height = std::clamp(rect.height, 0, image_height - top);
+    if (source_width == 0 || source_height == 0) {
+        return {};
+    }
+
+    // fit the thumbnail into the cell, keeping its aspect ratio
+    int width = GOOFORGE_THUMBNAIL_SIZE;
+    int height = GOOFORGE_THUMBNAIL_SIZE;
+    if (source_width > source_height) {
+        height = std::max(1, height * source_height / source_width);
+    } else {
+        width = std::max(1, width * source_width / source_height);
+    }
+    width = std::min(width, source_width);
+    height = std::min(height, source_height);
+    int offset_x = (GOOFORGE_THUMBNAIL_SIZE - width) / 2;
+    int offset_y = (GOOFORGE_THUMBNAIL_SIZE - height) / 2;
+
+    std::vector<uint8_t> pixels(GOOFORGE_THUMBNAIL_SIZE *
+                                GOOFORGE_THUMBNAIL_SIZE * 4);
+    const uint8_t* source = image.getPixels();
+    for (int y = 0; y < height; ++y) {
+        int source_y0 = top + y * source_height / height;
+        int source_y1 =
+            std::max(source_y0 + 1, top + (y + 1) * source_height / height);
+
+        for (int x = 0; x < width; ++x) {
+            int source_x0 = left + x * source_width / width;
+            int source_x1 =
+                std::max(source_x0 + 1, left + (x + 1) * source_width / width);
+
+            std::array<uint64_t, 4> sum = {0, 0, 0, 0};
+            uint64_t count = 0;
+            for (int sy = source_y0; sy < source_y1; ++sy) {
+                const uint8_t* row =
+                    source + static_cast<size_t>(sy) * image_width * 4;
+                for (int sx = source_x0; sx < source_x1; ++sx) {
+                    const uint8_t* pixel = row + sx * 4;
+                    sum[0] += pixel[0] * pixel[3];
+                    sum[1] += pixel[1] * pixel[3];
+                    sum[2] += pixel[2] * pixel[3];
+                    sum[3] += pixel[3];
+                    ++count;
+                }
+            }
+
+            uint8_t* destination =
+                &pixels[((offset_y + y) * GOOFORGE_THUMBNAIL_SIZE + offset_x +
+                         x) *
+                        4];
+            if (sum[3]) {
+                destination[0] = static_cast<uint8_t>(sum[0] / sum[3]);
+                destination[1] = static_cast<uint8_t>(sum[1] / sum[3]);
+                destination[2] = static_cast<uint8_t>(sum[2] / sum[3]);
+            }
+            destination[3] = static_cast<uint8_t>(sum[3] / count);
+        }
+    }
+
+    return pixels;
+}
+
+} // namespace
+
+ThumbnailAtlas* ThumbnailAtlas::getInstance() {
+    if (!ThumbnailAtlas::instance) {
+        ThumbnailAtlas::instance = new ThumbnailAtlas();
+    }
+
+    return ThumbnailAtlas::instance;
+}
+
+// returns the sprite itself until its thumbnail has been made
+sf::Sprite ThumbnailAtlas::get(const sf::Sprite& sprite) {
+    const sf::Texture* texture = sprite.getTexture();
+    if (!texture || texture->getSize().x == 0 || texture->getSize().y == 0 ||
+        texture == ResourceManager::getInstance()->getPlaceholderTexture()) {
+        return sprite;
+    }
+
+    sf::IntRect rect = sprite.getTextureRect();
+    Key key = {texture, rect.left, rect.top, rect.width, rect.height};
+    auto cell = this->cells.find(key);
+    if (cell != this->cells.end()) {
+        return this->getCellSprite(cell->second);
+    }
+
+    if (!this->pending.contains(key)) {
+        this->requested.insert(key);
+    }
+
+    return sprite;
+}
+
+void ThumbnailAtlas::update() {
+    ResourceManager* resource_manager = ResourceManager::getInstance();
+
+    // requested is sorted by texture, so each run of keys becomes a job
+    auto begin = this->requested.begin();
+    while (begin != this->requested.end()) {
+        const sf::Texture* texture = std::get<0>(*begin);
+        auto end = begin;
+        while (end != this->requested.end() && std::get<0>(*end) == texture) {
+            ++end;
+        }
+
+        // gone since it was asked for, it'll be asked for again if needed
+        SpriteResource* texture_resource =
+            resource_manager->getTextureOwner(texture);
+        if (!texture_resource) {
+            begin = end;
+            continue;
+        }
+
+        std::vector<Key> keys(begin, end);
+        this->pending.insert(keys.begin(), keys.end());
+        auto thumbnails = ThreadPool::getInstance()->submit(
+            [texture_resource, keys] {
+                std::vector<std::vector<uint8_t>> thumbnails(keys.size());
+                try {
+                    auto image = texture_resource->decode();
+                    if (!image) {
+                        return thumbnails;
+                    }
+
+                    for (size_t i = 0; i < keys.size(); ++i) {
+                        auto [texture, left, top, width, height] = keys[i];
+                        thumbnails[i] = makeThumbnail(
+                            *image, sf::IntRect(left, top, width, height));
+                    }
+                } catch (const std::exception& exception) {
+                    spdlog::error("Failed to make thumbnails for '{}': {}",
+                                  texture_resource->getPath(),
+                                  exception.what());
+                }
+
+                return thumbnails;
+            });
+        this->jobs.push_back(
+            {texture, false, std::move(keys), std::move(thumbnails)});
+
+        begin = end;
+    }
+
+    this->requested.clear();
+
+    for (auto job = this->jobs.begin(); job != this->jobs.end();) {
+        if (job->thumbnails.wait_for(std::chrono::seconds(0)) !=
+            std::future_status::ready) {
+            ++job;
+            continue;
+        }
+
+        auto thumbnails = job->thumbnails.get();
+        if (job->stale) {
+            job = this->jobs.erase(job);
+            continue;
+        }
+
+        for (size_t i = 0; i < job->keys.size(); ++i) {
+            this->finished.push_back({job->keys[i], std::move(thumbnails[i])});
+        }
+
+        job = this->jobs.erase(job);
+    }
+
+    // copying into a page is a texture upload, so only a few go per frame
+    for (size_t i = 0;
+         i < GOOFORGE_MAX_THUMBNAILS_PER_FRAME && !this->finished.empty();
+         ++i) {
+        auto [key, pixels] = std::move(this->finished.front());
+        this->finished.pop_front();
+        this->pending.erase(key);
+
+        // couldn't be made, the sprite itself keeps being shown
+        if (pixels.empty()) {
+            continue;
+        }
+
+        size_t new_cell = this->allocateCell();
+        sf::Texture* page = this->pages[new_cell / cells_per_page].get();
+        size_t page_cell = new_cell % cells_per_page;
+        page->update(pixels.data(), GOOFORGE_THUMBNAIL_SIZE,
+                     GOOFORGE_THUMBNAIL_SIZE,
+                     (page_cell % cells_per_row) * GOOFORGE_THUMBNAIL_SIZE,
+                     (page_cell / cells_per_row) * GOOFORGE_THUMBNAIL_SIZE);
+
+        this->cells.insert({key, new_cell});
+    }
+}
+
+// drops every thumbnail made from the texture, for when its contents change
+void ThumbnailAtlas::invalidate(const sf::Texture* texture) {
+    auto begin = this->cells.lower_bound({texture, INT_MIN, INT_MIN, INT_MIN,
+                                          INT_MIN});
+    auto end = begin;
+    while (end != this->cells.end() && std::get<0>(end->first) == texture) {
+        this->free_cells.push_back(end->second);
+        ++end;
+    }
+
+    this->cells.erase(begin, end);
+
+    std::erase_if(this->requested, [texture](const Key& key) {
+        return std::get<0>(key) == texture;
+    });
+    std::erase_if(this->pending, [texture](const Key& key) {
+        return std::get<0>(key) == texture;
+    });
+    std::erase_if(this->finished, [texture](const auto& thumbnail) {
+        return std::get<0>(thumbnail.first) == texture;
+    });
+    for (Job& job : this->jobs) {
+        if (job.texture == texture) {
+            job.stale = true;
+        }
+    }
+}
+
+// the pages themselves are kept, only their cells are forgotten
+void ThumbnailAtlas::clear() {
+    this->cells.clear();
+    this->free_cells.clear();
+    this->next_cell = 0;
+    this->requested.clear();
+    this->pending.clear();
+    this->finished.clear();
+    for (Job& job : this->jobs) {
+        job.stale = true;
+    }
+}
+
+size_t ThumbnailAtlas::allocateCell() {
+    if (!this->free_cells.empty()) {
+        size_t cell = this->free_cells.back();
+        this->free_cells.pop_back();
+
+        return cell;
+    }
+
+    size_t cell = this->next_cell++;
+    if (cell / cells_per_page >= this->pages.size()) {
+        auto page = std::make_unique<sf::Texture>();
+        page->create(GOOFORGE_THUMBNAIL_ATLAS_SIZE,
+                     GOOFORGE_THUMBNAIL_ATLAS_SIZE);
+        page->setSmooth(true);
+        this->pages.push_back(std::move(page));
+    }
+
+    return cell;
+}
+
+sf::Sprite ThumbnailAtlas::getCellSprite(size_t cell) {
+    size_t page_cell = cell % cells_per_page;
+
+    return sf::Sprite(
+        *this->pages[cell / cells_per_page],
+        sf::IntRect((page_cell % cells_per_row) * GOOFORGE_THUMBNAIL_SIZE,
+                    (page_cell / cells_per_row) * GOOFORGE_THUMBNAIL_SIZE,
+                    GOOFORGE_THUMBNAIL_SIZE, GOOFORGE_THUMBNAIL_SIZE));
+}
+
+ThumbnailAtlas* ThumbnailAtlas::instance = nullptr;
+
+} // namespace gooforge